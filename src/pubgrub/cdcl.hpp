@@ -0,0 +1,848 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+#include <pubgrub/debug.hpp>
+#include <pubgrub/solve.hpp>
+
+#include <neo/assert.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <list>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pubgrub {
+
+namespace detail {
+
+/**
+ * A small conflict-driven clause learning SAT solver.
+ *
+ * Clauses are watched by two literals, conflicts are analyzed to the first unique implication
+ * point, and the learned clause decides how far to backjump. Clauses may be added during
+ * `solve()`, from the callback that is given each variable as it becomes true, so that a problem
+ * can be encoded as the search reaches it.
+ *
+ * Decisions are directed by the "requirement" clauses. A requirement clause has at most one
+ * negative literal, and is active while that literal is false. The first active requirement clause
+ * that is not yet satisfied has its first unassigned positive literal set to true. Variables that
+ * are still unassigned when every active requirement clause is satisfied are false in the model.
+ * This makes the model minimal in the same way that a dependency solution is: Nothing is selected
+ * unless it is required.
+ *
+ * Every clause remembers where it came from, so that if there is no satisfying assignment,
+ * `refute()` can replay the resolution steps that lead from the added clauses to the empty clause.
+ */
+class cdcl_core {
+public:
+    using literal = std::uint32_t;
+
+    static literal positive(std::size_t var) noexcept { return static_cast<literal>(var * 2); }
+    static literal negative(std::size_t var) noexcept { return static_cast<literal>(var * 2 + 1); }
+
+private:
+    static constexpr std::size_t no_reason = std::numeric_limits<std::size_t>::max();
+
+    using clause = std::vector<literal>;
+
+    // Where a clause came from: The number of the added clause, or the clauses that a learned
+    // clause was resolved from, in order. Literals that were false at level zero were then dropped
+    // from a learned clause, which resolves it with the reasons of those literals as well.
+    struct origin {
+        std::size_t              added = no_reason;
+        std::vector<std::size_t> antecedents{};
+    };
+
+    struct active_requirement {
+        std::size_t index;
+        // One past the trail position of the literal that activated the requirement, or zero if
+        // the requirement is always active
+        std::size_t trail_end;
+    };
+
+    std::vector<clause>                   _clauses;
+    std::vector<origin>                   _origins;
+    std::vector<std::vector<std::size_t>> _watches;
+
+    std::vector<clause>                   _requirements;
+    std::vector<std::vector<std::size_t>> _activations;
+    std::vector<active_requirement>       _active;
+    // Every active requirement before this one is satisfied
+    std::size_t _decide_head = 0;
+
+    std::vector<std::int8_t>  _values;
+    std::vector<std::size_t>  _levels;
+    std::vector<std::size_t>  _reasons;
+    std::vector<std::size_t>  _trail_positions;
+    std::vector<std::uint8_t> _seen;
+
+    std::vector<literal>     _trail;
+    std::vector<std::size_t> _level_starts;
+    std::vector<std::size_t> _level_decide_heads;
+    std::size_t              _qhead       = 0;
+    std::size_t              _expand_head = 0;
+    bool                     _unsat       = false;
+    // Once unsatisfiable, the clause whose literals are all false at level zero
+    std::size_t _refuted = no_reason;
+
+    // Clauses that have been added but not yet attached, whether each is a requirement, and the
+    // number of each in the order they were added
+    struct added_clause {
+        clause      literals;
+        bool        is_requirement;
+        std::size_t number;
+    };
+    std::deque<added_clause> _added;
+    std::size_t              _n_added = 0;
+
+    static std::size_t _var_of(literal l) noexcept { return l >> 1; }
+    static literal     _negate(literal l) noexcept { return l ^ 1; }
+    static bool        _is_negative(literal l) noexcept { return (l & 1) != 0; }
+
+    // 1 if true, 0 if false, -1 if unassigned
+    int _value(literal l) const noexcept {
+        const int v = _values[_var_of(l)];
+        return v < 0 ? -1 : (v ^ static_cast<int>(l & 1));
+    }
+
+    std::size_t _level() const noexcept { return _level_starts.size(); }
+
+    void _assign(literal l, std::size_t reason) {
+        const auto var        = _var_of(l);
+        _values[var]          = _is_negative(l) ? 0 : 1;
+        _levels[var]          = _level();
+        _reasons[var]         = reason;
+        _trail_positions[var] = _trail.size();
+        _trail.push_back(l);
+        if (!_is_negative(l)) {
+            for (std::size_t req : _activations[var]) {
+                _active.push_back({req, _trail.size()});
+            }
+        }
+    }
+
+    std::size_t _store(clause c, origin o) {
+        _clauses.push_back(std::move(c));
+        _origins.push_back(std::move(o));
+        return _clauses.size() - 1;
+    }
+
+    std::size_t _watch(std::size_t idx) {
+        _watches[_clauses[idx][0]].push_back(idx);
+        _watches[_clauses[idx][1]].push_back(idx);
+        return idx;
+    }
+
+    void _refute(std::size_t idx) noexcept {
+        _unsat   = true;
+        _refuted = idx;
+    }
+
+    /**
+     * Watch a stored clause of at least two literals under the current assignment. If the clause is
+     * unit, backjump to where it became unit and propagate it. If every literal is false, backjump
+     * to where it became false and return it as a conflict.
+     */
+    std::size_t _attach(std::size_t idx) {
+        clause& c = _clauses[idx];
+        // True literals first, then unassigned literals, then false literals from the latest
+        auto rank = [&](literal l) {
+            const auto level = _levels[_var_of(l)];
+            switch (_value(l)) {
+            case 1:
+                return std::pair{0, level};
+            case 0:
+                return std::pair{2, std::numeric_limits<std::size_t>::max() - level};
+            default:
+                return std::pair{1, std::size_t(0)};
+            }
+        };
+        std::ranges::sort(c, std::less<>{}, rank);
+        const int v0 = _value(c[0]);
+        if (_value(c[1]) != 0) {
+            _watch(idx);
+            return no_reason;
+        }
+        // Every literal but the first is false
+        const auto false_level = _levels[_var_of(c[1])];
+        if (v0 == 1 && _levels[_var_of(c[0])] <= false_level) {
+            _watch(idx);
+            return no_reason;
+        }
+        if (v0 == 0) {
+            _backtrack(_levels[_var_of(c[0])]);
+            return _watch(idx);
+        }
+        _backtrack(false_level);
+        _assign(c[0], _watch(idx));
+        return no_reason;
+    }
+
+    /**
+     * Propagate every pending assignment. Returns the index of a conflicting clause, if any.
+     */
+    std::size_t _propagate() {
+        while (_qhead < _trail.size()) {
+            const literal false_lit = _negate(_trail[_qhead++]);
+            auto&         watching  = _watches[false_lit];
+            std::size_t   keep      = 0;
+            for (std::size_t i = 0; i < watching.size(); ++i) {
+                const auto ci = watching[i];
+                auto&      c  = _clauses[ci];
+                if (c[0] == false_lit) {
+                    std::swap(c[0], c[1]);
+                }
+                if (_value(c[0]) == 1) {
+                    watching[keep++] = ci;
+                    continue;
+                }
+                auto other = std::find_if(c.begin() + 2, c.end(), [&](literal l) {
+                    return _value(l) != 0;
+                });
+                if (other != c.end()) {
+                    std::swap(c[1], *other);
+                    _watches[c[1]].push_back(ci);
+                    continue;
+                }
+                watching[keep++] = ci;
+                if (_value(c[0]) == 0) {
+                    // Every literal is false
+                    for (++i; i < watching.size(); ++i) {
+                        watching[keep++] = watching[i];
+                    }
+                    watching.resize(keep);
+                    _qhead = _trail.size();
+                    return ci;
+                }
+                _assign(c[0], ci);
+            }
+            watching.resize(keep);
+        }
+        return no_reason;
+    }
+
+    /**
+     * Derive a learned clause from a conflict. The asserting literal is first, and the literal
+     * with the highest remaining decision level is second. The clauses that it was resolved from
+     * are appended to `antecedents`.
+     */
+    clause _analyze(std::size_t conflict, std::vector<std::size_t>& antecedents) {
+        clause      learned{0};
+        std::size_t n_pending = 0;
+        std::size_t idx       = _trail.size();
+        literal     uip       = 0;
+        bool        have_uip  = false;
+        do {
+            antecedents.push_back(conflict);
+            for (literal q : _clauses[conflict]) {
+                if (have_uip && q == uip) {
+                    continue;
+                }
+                const auto var = _var_of(q);
+                if (_seen[var] || _levels[var] == 0) {
+                    continue;
+                }
+                _seen[var] = 1;
+                if (_levels[var] == _level()) {
+                    ++n_pending;
+                } else {
+                    learned.push_back(q);
+                }
+            }
+            do {
+                --idx;
+            } while (!_seen[_var_of(_trail[idx])]);
+            uip      = _trail[idx];
+            have_uip = true;
+            conflict = _reasons[_var_of(uip)];
+            _seen[_var_of(uip)] = 0;
+        } while (--n_pending > 0);
+
+        learned[0] = _negate(uip);
+        for (auto it = learned.begin() + 1; it != learned.end(); ++it) {
+            _seen[_var_of(*it)] = 0;
+        }
+        if (learned.size() > 1) {
+            auto highest = std::max_element(learned.begin() + 1,
+                                            learned.end(),
+                                            [&](literal a, literal b) {
+                                                return _levels[_var_of(a)] < _levels[_var_of(b)];
+                                            });
+            std::swap(learned[1], *highest);
+        }
+        return learned;
+    }
+
+    void _backtrack(std::size_t level) {
+        if (level >= _level()) {
+            return;
+        }
+        const auto stop = _level_starts[level];
+        while (_trail.size() > stop) {
+            const auto var = _var_of(_trail.back());
+            _values[var]   = -1;
+            _reasons[var]  = no_reason;
+            _trail.pop_back();
+        }
+        _decide_head = _level_decide_heads[level];
+        _level_starts.resize(level);
+        _level_decide_heads.resize(level);
+        _qhead       = _trail.size();
+        _expand_head = std::min(_expand_head, _trail.size());
+        std::erase_if(_active, [&](auto&& act) { return act.trail_end > _trail.size(); });
+    }
+
+    void _activate(const clause& req) {
+        const auto idx       = _requirements.size();
+        auto       activator = std::ranges::find_if(req, _is_negative);
+        if (activator == req.end()) {
+            _active.push_back({idx, 0});
+        } else {
+            const auto var = _var_of(*activator);
+            _activations[var].push_back(idx);
+            if (_value(*activator) == 0) {
+                _active.push_back({idx, _trail_positions[var] + 1});
+            }
+        }
+        _requirements.push_back(req);
+    }
+
+    /**
+     * Attach the clauses that have been added since the last call, stopping at the first that
+     * conflicts with the current assignment. Returns the index of that clause, if any.
+     */
+    std::size_t _attach_added() {
+        while (!_added.empty() && !_unsat) {
+            auto [c, is_requirement, number] = std::move(_added.front());
+            _added.pop_front();
+            if (is_requirement) {
+                _activate(c);
+            }
+            std::ranges::sort(c);
+            c.erase(std::unique(c.begin(), c.end()), c.end());
+            if (std::ranges::adjacent_find(c, [](literal a, literal b) { return b == _negate(a); })
+                != c.end()) {
+                // Always satisfied
+                continue;
+            }
+            const auto size = c.size();
+            const auto idx  = _store(std::move(c), {number});
+            if (size == 0) {
+                _refute(idx);
+            } else if (size == 1) {
+                _backtrack(0);
+                const literal lit = _clauses[idx][0];
+                const int     val = _value(lit);
+                if (val == 0) {
+                    _refute(idx);
+                } else if (val < 0) {
+                    _assign(lit, idx);
+                }
+            } else if (auto conflict = _attach(idx); conflict != no_reason) {
+                return conflict;
+            }
+        }
+        return no_reason;
+    }
+
+    /**
+     * Pass each variable that has become true since the last call to the callback, and attach the
+     * clauses that it adds. Returns the index of a conflicting clause, if any.
+     */
+    template <typename Expand>
+    std::size_t _expand_assigned(Expand& expand) {
+        while (_expand_head < _trail.size() && !_unsat) {
+            const literal l = _trail[_expand_head++];
+            if (_is_negative(l)) {
+                continue;
+            }
+            expand(_var_of(l));
+            if (auto conflict = _attach_added(); conflict != no_reason) {
+                return conflict;
+            }
+        }
+        return no_reason;
+    }
+
+    std::optional<literal> _next_decision() noexcept {
+        for (; _decide_head < _active.size(); ++_decide_head) {
+            const clause& req = _requirements[_active[_decide_head].index];
+            if (std::ranges::any_of(req, [&](literal l) { return _value(l) == 1; })) {
+                continue;
+            }
+            auto next = std::ranges::find_if(req, [&](literal l) {
+                return !_is_negative(l) && _value(l) == -1;
+            });
+            if (next != req.end()) {
+                return *next;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // The resolvent of two clauses that clash on a single variable
+    static clause _resolvent(const clause& a, const clause& b) {
+        auto has = [](const clause& c, literal l) { return std::ranges::find(c, l) != c.end(); };
+        clause ret;
+        for (literal l : a) {
+            if (!has(b, _negate(l))) {
+                ret.push_back(l);
+            }
+        }
+        for (literal l : b) {
+            if (!has(a, _negate(l)) && !has(ret, l)) {
+                ret.push_back(l);
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * Replay a derivation that starts with the clause `first` and resolves it with each of `rest`
+     * in turn. Then every literal that is not in `keep` is resolved away with its reason, from the
+     * latest assigned, as each of them was false at level zero. `step` is given each clause that
+     * is resolved in, along with the resolvent.
+     */
+    template <typename Step>
+    void _replay(std::size_t                  first,
+                 std::span<const std::size_t> rest,
+                 const clause&                keep,
+                 Step&&                       step) const {
+        clause lits = _clauses[first];
+        for (std::size_t idx : rest) {
+            lits = _resolvent(lits, _clauses[idx]);
+            step(idx, lits);
+        }
+        while (true) {
+            auto dropped = std::ranges::end(lits);
+            for (auto it = lits.begin(); it != lits.end(); ++it) {
+                if (std::ranges::find(keep, *it) == keep.end()
+                    && (dropped == lits.end()
+                        || _trail_positions[_var_of(*dropped)] < _trail_positions[_var_of(*it)])) {
+                    dropped = it;
+                }
+            }
+            if (dropped == lits.end()) {
+                break;
+            }
+            const auto var = _var_of(*dropped);
+            neo_assert(invariant,
+                       _levels[var] == 0 && _value(*dropped) == 0 && _reasons[var] != no_reason,
+                       "A literal was dropped from a clause without being false at level zero");
+            const auto reason = _reasons[var];
+            lits              = _resolvent(lits, _clauses[reason]);
+            step(reason, lits);
+        }
+        neo_assert(invariant,
+                   lits.size() == keep.size(),
+                   "Replaying a derivation did not reproduce its clause");
+    }
+
+public:
+    std::size_t new_var() {
+        const auto var = _values.size();
+        _values.push_back(-1);
+        _levels.push_back(0);
+        _reasons.push_back(no_reason);
+        _trail_positions.push_back(0);
+        _seen.push_back(0);
+        _activations.emplace_back();
+        _watches.resize(_watches.size() + 2);
+        return var;
+    }
+
+    /**
+     * Add a clause. A requirement clause directs decisions, and should list its positive literals
+     * in order of preference.
+     */
+    void add_clause(clause c, bool is_requirement = false) {
+        _added.push_back({std::move(c), is_requirement, _n_added++});
+    }
+
+    /**
+     * Search for a satisfying assignment. Returns `false` if there is none.
+     *
+     * `expand` is called with each variable as it becomes true, and may add clauses.
+     */
+    template <typename Expand>
+    bool solve(Expand&& expand) {
+        while (!_unsat) {
+            auto conflict = _propagate();
+            if (conflict == no_reason) {
+                conflict = _attach_added();
+            }
+            if (conflict == no_reason) {
+                conflict = _expand_assigned(expand);
+            }
+            if (_unsat) {
+                break;
+            }
+            if (conflict != no_reason) {
+                if (_level() == 0) {
+                    _refute(conflict);
+                    break;
+                }
+                origin     learned_from;
+                clause     learned   = _analyze(conflict, learned_from.antecedents);
+                const auto asserting = learned[0];
+                const auto idx       = _store(std::move(learned), std::move(learned_from));
+                if (_clauses[idx].size() == 1) {
+                    _backtrack(0);
+                    _assign(asserting, idx);
+                } else {
+                    _backtrack(_levels[_var_of(_clauses[idx][1])]);
+                    _assign(asserting, _watch(idx));
+                }
+                continue;
+            }
+            if (_qhead < _trail.size()) {
+                // The callback assigned more variables
+                continue;
+            }
+            auto next = _next_decision();
+            if (!next) {
+                return true;
+            }
+            _level_starts.push_back(_trail.size());
+            _level_decide_heads.push_back(_decide_head);
+            _assign(*next, no_reason);
+        }
+        return false;
+    }
+
+    bool solve() {
+        return solve([](std::size_t) {});
+    }
+
+    /// The value of a variable in the model found by `solve()`
+    bool model_value(std::size_t var) const noexcept { return _values[var] == 1; }
+
+    /**
+     * Replay the resolution proof that there is no satisfying assignment, once `solve()` has
+     * returned `false`. `added` is called with the number of each added clause that the proof
+     * uses, counting from zero in the order of `add_clause()`, along with its literals. `resolve`
+     * is called with the results for two clauses and the literals of their resolvent. Every clause
+     * is derived before it is used. Returns the result for the empty clause.
+     */
+    template <typename Added, typename Resolve>
+    auto refute(Added&& added, Resolve&& resolve) const {
+        using result_type = std::remove_cvref_t<decltype(added(std::size_t(0), clause{}))>;
+        neo_assert(expects, _unsat, "Only an unsatisfiable problem has a refutation");
+
+        // Mark the clauses that the proof uses. A clause is only derived from those before it.
+        std::vector<std::uint8_t> needed(_clauses.size(), 0);
+        auto                      mark = [&](std::size_t idx, const clause&) { needed[idx] = 1; };
+        needed[_refuted]               = 1;
+        _replay(_refuted, {}, {}, mark);
+        for (auto idx = _clauses.size(); idx-- > 0;) {
+            if (needed[idx] && _origins[idx].added == no_reason) {
+                const auto& from = _origins[idx].antecedents;
+                needed[from[0]]  = 1;
+                _replay(from[0], std::span(from).subspan(1), _clauses[idx], mark);
+            }
+        }
+
+        std::vector<std::optional<result_type>> results(_clauses.size());
+        auto derive = [&](std::size_t                  first,
+                          std::span<const std::size_t> rest,
+                          const clause&                keep) {
+            result_type acc = *results[first];
+            _replay(first, rest, keep, [&](std::size_t idx, const clause& lits) {
+                acc = resolve(acc, *results[idx], lits);
+            });
+            return acc;
+        };
+        for (std::size_t idx = 0; idx < _clauses.size(); ++idx) {
+            if (!needed[idx]) {
+                continue;
+            }
+            const origin& o = _origins[idx];
+            if (o.added != no_reason) {
+                results[idx].emplace(added(o.added, _clauses[idx]));
+            } else {
+                results[idx].emplace(derive(o.antecedents[0],
+                                            std::span(o.antecedents).subspan(1),
+                                            _clauses[idx]));
+            }
+        }
+        return derive(_refuted, {}, {});
+    }
+};
+
+}  // namespace detail
+
+/**
+ * Solve for the given roots by translating the package graph into clauses for a CDCL SAT solver.
+ *
+ * Each candidate is a variable, each package admits at most one candidate, each root requires one
+ * of its candidates, and each candidate implies one of the candidates of each of its dependencies.
+ * The dependencies of a candidate are only encoded once the search sets it to true, so packages
+ * that are never selected are never expanded. Candidates are found with `best_candidate()`, so the
+ * newest acceptable candidates are preferred, as with `solve()`, and the candidates within each
+ * distinct requirement are only looked up once. The solution is valid but is not necessarily the
+ * same one that `solve()` would find. It is passed to a `commit_observer` once it is complete.
+ *
+ * If there is no solution, the resolution proof of the SAT solver is translated back into
+ * incompatibilities, and the same unsolvable_failure is thrown as by `solve()`. Each clause
+ * becomes the incompatibility of the terms that it rules out. A root or dependency clause is
+ * derived from the root or dependency incompatibility and, if some versions of the requirement
+ * had no candidate, the incompatibility that makes those unavailable. Each resolution step
+ * becomes a `conflict_cause` incompatibility. The at-most-one clauses only restate that a package
+ * has a single version, which the terms already say, so the steps that use them are skipped.
+ */
+template <requirement_range Range, provider<std::ranges::range_value_t<Range>> P>
+auto solve_cdcl(Range&& roots, P&& p, const solve_options& opts = {}) {
+    using requirement_type = std::ranges::range_value_t<Range>;
+    using key_type         = key_type_t<requirement_type>;
+    using ic_type          = incompatibility<requirement_type>;
+    using term_type        = typename ic_type::term_type;
+    using term_vec         = typename ic_type::term_vec;
+    using cdcl             = detail::cdcl_core;
+    using literal_vec      = std::vector<cdcl::literal>;
+
+    constexpr auto no_candidate = std::numeric_limits<std::size_t>::max();
+
+    struct package {
+        // The candidate index of each of the package's candidates
+        std::vector<std::size_t> candidates{};
+        // The candidate literals within each requirement that has been looked up, newest first
+        std::vector<std::pair<requirement_type, literal_vec>> lookups{};
+        // The last variable of the sequential counter: It is true if any candidate is selected
+        std::optional<std::size_t> any_selected{};
+    };
+
+    // What each clause that was added to the core says, in the order they were added: That a
+    // root or a candidate needs one of the candidates of `required`, or (with no `required`) that
+    // a package has a single version.
+    struct origin {
+        std::optional<requirement_type> dependent{};
+        std::optional<requirement_type> required{};
+    };
+
+    std::vector<requirement_type> root_reqs(std::ranges::begin(roots), std::ranges::end(roots));
+    debug::debug(p, "Encoding dependencies for CDCL: {}", neo::repr(debug::try_repr{root_reqs}));
+
+    cdcl                          core;
+    std::vector<origin>           origins;
+    std::vector<requirement_type> candidates;
+    std::vector<std::size_t>      var_of_candidate;
+    std::vector<bool>             expanded;
+    // The candidate index of each variable, or no_candidate for the counter variables
+    std::vector<std::size_t> candidate_of_var;
+    // The versions that each variable stands for: A candidate, or each candidate up to a counter
+    std::vector<requirement_type> req_of_var;
+    std::map<key_type, package>   packages;
+
+    auto add_clause = [&](literal_vec lits, bool is_requirement, origin o) {
+        core.add_clause(std::move(lits), is_requirement);
+        origins.push_back(std::move(o));
+    };
+
+    auto new_var = [&](std::size_t cand_idx, const requirement_type& versions) {
+        const auto var = core.new_var();
+        candidate_of_var.push_back(cand_idx);
+        req_of_var.push_back(versions);
+        return var;
+    };
+
+    auto var_for = [&](package& pkg, const requirement_type& c) {
+        auto found = std::ranges::find_if(pkg.candidates, [&](std::size_t idx) {
+            return candidates[idx].implied_by(c) && c.implied_by(candidates[idx]);
+        });
+        if (found != pkg.candidates.end()) {
+            return var_of_candidate[*found];
+        }
+        const auto idx = candidates.size();
+        const auto var = new_var(idx, c);
+        candidates.push_back(c);
+        var_of_candidate.push_back(var);
+        expanded.push_back(false);
+        pkg.candidates.push_back(idx);
+        // At most one candidate, with a sequential counter: Selecting this candidate sets the
+        // counter, which forbids every later candidate.
+        std::optional<requirement_type> covered = c;
+        if (pkg.any_selected) {
+            covered = req_of_var[*pkg.any_selected].union_(c);
+            neo_assert(invariant,
+                       !!covered,
+                       "The candidates of a package must have a union",
+                       req_of_var[*pkg.any_selected],
+                       c);
+        }
+        const auto counter = new_var(no_candidate, *covered);
+        add_clause({cdcl::negative(var), cdcl::positive(counter)}, false, {});
+        if (pkg.any_selected) {
+            add_clause({cdcl::negative(*pkg.any_selected), cdcl::positive(counter)}, false, {});
+            add_clause({cdcl::negative(var), cdcl::negative(*pkg.any_selected)}, false, {});
+        }
+        pkg.any_selected = counter;
+        return var;
+    };
+
+    // Find (or create) the variables of every candidate within the requirement, newest first
+    auto literals_for = [&](const requirement_type& req) -> literal_vec {
+        auto& pkg   = packages[key_of(req)];
+        auto  known = std::ranges::find_if(pkg.lookups, [&](auto&& pair) {
+            return pair.first.implied_by(req) && req.implied_by(pair.first);
+        });
+        if (known != pkg.lookups.end()) {
+            return known->second;
+        }
+        literal_vec                     ret;
+        std::optional<requirement_type> remaining = req;
+        while (remaining) {
+            auto cand = p.best_candidate(*remaining);
+            if (!cand || !remaining->implied_by(*cand)) {
+                break;
+            }
+            const requirement_type& c = *cand;
+            ret.push_back(cdcl::positive(var_for(pkg, c)));
+            auto diff = remaining->difference(c);
+            if (diff && diff->implied_by(c)) {
+                // The provider's candidate did not narrow the requirement
+                break;
+            }
+            remaining = diff ? std::optional<requirement_type>(*diff) : std::nullopt;
+        }
+        pkg.lookups.emplace_back(req, ret);
+        return ret;
+    };
+
+    // Encode the dependencies of a candidate once it has been selected
+    auto expand = [&](std::size_t var) {
+        const auto idx = candidate_of_var[var];
+        if (idx == no_candidate || expanded[idx]) {
+            return;
+        }
+        expanded[idx]               = true;
+        const requirement_type cand = candidates[idx];
+        for (const requirement_type& dep : p.requirements_of(cand)) {
+            if (key_of(dep) == key_of(cand)) {
+                throw std::runtime_error("Package cannot depend on itself.");
+            }
+            auto lits = literals_for(dep);
+            lits.insert(lits.begin(), cdcl::negative(var));
+            add_clause(std::move(lits), true, {cand, dep});
+        }
+    };
+
+    for (const requirement_type& root : root_reqs) {
+        add_clause(literals_for(root), true, {std::nullopt, root});
+    }
+    const bool satisfiable = core.solve(expand);
+    debug::debug(p,
+                 "Expanded {} of {} candidates",
+                 std::ranges::count(expanded, true),
+                 candidates.size());
+
+    if (satisfiable) {
+        std::vector<requirement_type> ret;
+        for (std::size_t idx = 0; idx < candidates.size(); ++idx) {
+            if (core.model_value(var_of_candidate[idx])) {
+                ret.push_back(candidates[idx]);
+            }
+        }
+        if constexpr (commit_observer<std::remove_cvref_t<P>, requirement_type>) {
+            for (const requirement_type& cand : ret) {
+                p.on_commit(cand);
+            }
+        }
+        return ret;
+    }
+
+    debug::debug(p, "The clauses are unsatisfiable. Translating the proof into incompatibilities.");
+    const auto         alloc = typename ic_type::allocator_type{};
+    std::list<ic_type> ics;
+    if (!opts.retain_explanations) {
+        ics.emplace_back(term_vec{alloc}, alloc, typename ic_type::learned_cause{});
+        throw unsolvable_failure<ic_type>(std::move(ics));
+    }
+
+    // The terms that a clause rules out, or nothing if it holds for any versions
+    auto terms_of = [&](const literal_vec& lits) -> std::optional<term_vec> {
+        term_vec terms{alloc};
+        for (cdcl::literal lit : lits) {
+            // A clause rules out its literals all being false
+            terms.push_back(term_type{req_of_var[lit >> 1], (lit & 1) != 0});
+        }
+        std::ranges::sort(terms, std::less<>{}, pubgrub::key_of);
+        term_vec coalesced{alloc};
+        for (const term_type& t : terms) {
+            if (coalesced.empty() || coalesced.back().key() != t.key()) {
+                coalesced.push_back(t);
+            } else if (auto isect = coalesced.back().intersection(t)) {
+                coalesced.back() = std::move(*isect);
+            } else {
+                return std::nullopt;
+            }
+        }
+        return coalesced;
+    };
+
+    // The derivation of an added clause from the incompatibilities that it encodes
+    auto ic_of_added = [&](std::size_t number, const literal_vec& lits) -> const ic_type* {
+        const origin& o = origins[number];
+        if (!o.required) {
+            return nullptr;
+        }
+        const requirement_type& req = *o.required;
+        const ic_type*          ic  = nullptr;
+        if (o.dependent) {
+            term_vec terms{{term_type{*o.dependent}, term_type{req, false}}, alloc};
+            ic = &ics.emplace_back(terms, alloc, typename ic_type::dependency_cause{});
+        } else {
+            term_vec terms{{term_type{req, false}}, alloc};
+            ic = &ics.emplace_back(terms, alloc, typename ic_type::root_cause{});
+        }
+        // The versions of the requirement that are not among its candidates
+        std::optional<requirement_type> missing = req;
+        for (cdcl::literal lit : lits) {
+            if ((lit & 1) == 0 && missing) {
+                auto diff = missing->difference(req_of_var[lit >> 1]);
+                missing   = diff ? std::optional<requirement_type>(*diff) : std::nullopt;
+            }
+        }
+        if (!missing) {
+            return ic;
+        }
+        const ic_type& unavail = ics.emplace_back(term_vec{{term_type{*missing}}, alloc},
+                                                  alloc,
+                                                  typename ic_type::unavailable_cause{});
+        return &ics.emplace_back(*terms_of(lits),
+                                 alloc,
+                                 typename ic_type::conflict_cause{*ic, unavail});
+    };
+
+    auto resolve = [&](const ic_type* left,
+                       const ic_type* right,
+                       const literal_vec& lits) -> const ic_type* {
+        if (!left || !right) {
+            // Resolving with a clause that always holds adds nothing
+            return left ? left : right;
+        }
+        auto terms = terms_of(lits);
+        if (!terms) {
+            return nullptr;
+        }
+        return &ics.emplace_back(std::move(*terms),
+                                 alloc,
+                                 typename ic_type::conflict_cause{*left, *right});
+    };
+
+    const ic_type* root = core.refute(ic_of_added, resolve);
+    neo_assert(invariant,
+               root && root->terms().empty(),
+               "The CDCL refutation did not translate into a failed solve. This is a bug.");
+    // The failure's root must come last
+    ics.splice(ics.end(), ics, std::ranges::find_if(ics, [&](auto&& ic) { return &ic == root; }));
+    throw unsolvable_failure<ic_type>(std::move(ics));
+}
+
+}  // namespace pubgrub
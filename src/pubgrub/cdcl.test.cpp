@@ -0,0 +1,280 @@
+#include "./cdcl.hpp"
+
+#include <pubgrub/memory_provider.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+
+using pubgrub::test::simple_req;
+using pubgrub::test::ver;
+
+namespace {
+
+// Check that a solution picks one candidate per package and satisfies every requirement
+bool is_valid_solution(const std::vector<simple_req>&              sln,
+                       const std::vector<simple_req>&              roots,
+                       const pubgrub::memory_provider<simple_req>& repo) {
+    auto satisfied = [&](const simple_req& req) {
+        return std::ranges::any_of(sln, [&](auto&& cand) {
+            return cand.key == req.key && req.implied_by(cand);
+        });
+    };
+    for (const auto& cand : sln) {
+        if (std::ranges::count(sln, cand.key, &simple_req::key) != 1) {
+            return false;
+        }
+        if (!std::ranges::all_of(repo.requirements_of(cand), satisfied)) {
+            return false;
+        }
+    }
+    return std::ranges::all_of(roots, satisfied);
+}
+
+struct problem {
+    pubgrub::test::counting_memory_provider repo;
+    std::vector<simple_req>                 roots;
+};
+
+// Generate a repository of up to `n_packages` packages with random versions and dependencies,
+// and two random roots
+problem random_problem(std::mt19937& rng, int n_packages) {
+    auto    pick = [&](int n) { return static_cast<int>(rng() % static_cast<unsigned>(n)); };
+    auto    name = [](int idx) { return std::string(1, static_cast<char>('a' + idx)); };
+    problem ret;
+    for (int pkg = 0; pkg < n_packages; ++pkg) {
+        const int n_versions = 1 + pick(4);
+        for (int v = 1; v <= n_versions; ++v) {
+            std::vector<simple_req> deps;
+            for (int dep = 0; dep < n_packages; ++dep) {
+                if (dep != pkg && pick(3) == 0) {
+                    const int low = 1 + pick(4);
+                    deps.push_back(simple_req{name(dep), {low, low + 1 + pick(3)}});
+                }
+            }
+            ret.repo.add(ver(name(pkg), v), deps);
+        }
+    }
+    for (int n = 0; n < 2; ++n) {
+        const int low = 1 + pick(3);
+        ret.roots.push_back(simple_req{name(pick(n_packages)), {low, low + 1 + pick(3)}});
+    }
+    return ret;
+}
+
+struct explain_handler {
+    std::stringstream message;
+
+    void say(pubgrub::explain::dependency<simple_req> dep) {
+        message << dep.dependent << " requires " << dep.dependency;
+    }
+
+    void say(pubgrub::explain::conflict<simple_req> conf) {
+        message << conf.a << " conflicts with " << conf.b;
+    }
+
+    void say(pubgrub::explain::needed<simple_req> need) {
+        message << need.requirement << " is needed";
+    }
+
+    void say(pubgrub::explain::no_solution) { message << "There is no solution"; }
+
+    void say(auto&&) { message << "(unexpected)"; }
+
+    void operator()(pubgrub::explain::separator) { message << '\n'; }
+
+    template <typename What>
+    void operator()(pubgrub::explain::conclusion<What> c) {
+        message << "Thus: ";
+        say(c.value);
+        message << '\n';
+    }
+
+    template <typename What>
+    void operator()(pubgrub::explain::premise<What> c) {
+        message << "Known: ";
+        say(c.value);
+        message << '\n';
+    }
+};
+
+}  // namespace
+
+TEST_CASE("CDCL core") {
+    using core = pubgrub::detail::cdcl_core;
+
+    SECTION("Pigeonhole is unsatisfiable") {
+        // Three pigeons, two holes
+        core c;
+        std::size_t v[3][2];
+        for (auto& pigeon : v) {
+            for (auto& hole : pigeon) {
+                hole = c.new_var();
+            }
+            c.add_clause({core::positive(pigeon[0]), core::positive(pigeon[1])}, true);
+        }
+        for (int hole = 0; hole < 2; ++hole) {
+            for (int a = 0; a < 3; ++a) {
+                for (int b = a + 1; b < 3; ++b) {
+                    c.add_clause({core::negative(v[a][hole]), core::negative(v[b][hole])});
+                }
+            }
+        }
+        CHECK_FALSE(c.solve());
+    }
+
+    SECTION("Conflicts are learned from") {
+        core c;
+        auto a = c.new_var();
+        auto b = c.new_var();
+        auto x = c.new_var();
+        // Prefer `a`, but `a` needs `x` and `x` is forbidden
+        c.add_clause({core::positive(a), core::positive(b)}, true);
+        c.add_clause({core::negative(a), core::positive(x)}, true);
+        c.add_clause({core::negative(x)});
+        REQUIRE(c.solve());
+        CHECK_FALSE(c.model_value(a));
+        CHECK(c.model_value(b));
+        CHECK_FALSE(c.model_value(x));
+    }
+}
+
+TEST_CASE("Solve with the CDCL engine") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("a", 1), {simple_req{"x", {1, 2}}});
+    repo.add(ver("a", 2), {simple_req{"x", {2, 3}}, simple_req{"y", {1, 3}}});
+    repo.add(ver("b", 1), {simple_req{"x", {1, 3}}});
+    repo.add(ver("b", 2), {simple_req{"y", {2, 3}}});
+    repo.add(ver("x", 1), {});
+    repo.add(ver("x", 2), {simple_req{"y", {1, 2}}});
+    repo.add(ver("y", 1), {});
+    repo.add(ver("y", 2), {});
+
+    SECTION("Newest candidates are preferred") {
+        auto roots = std::vector{simple_req{"b", {1, 3}}};
+        auto sln   = pubgrub::solve_cdcl(roots, repo);
+        CHECK(is_valid_solution(sln, roots, repo));
+        CHECK(sln == std::vector{ver("b", 2), ver("y", 2)});
+    }
+
+    SECTION("Backtracking is needed") {
+        auto roots = std::vector{simple_req{"a", {1, 3}}, simple_req{"b", {1, 3}}};
+        auto sln   = pubgrub::solve_cdcl(roots, repo);
+        CHECK(is_valid_solution(sln, roots, repo));
+    }
+
+    SECTION("Unsolvable roots are explained by incompatibilities") {
+        auto roots = std::vector{simple_req{"a", {2, 3}}, simple_req{"y", {2, 3}}};
+        try {
+            pubgrub::solve_cdcl(roots, repo);
+            FAIL("Expected a failure");
+        } catch (const pubgrub::solve_failure_type_t<simple_req>& fail) {
+            CHECK(fail.incompatibilities().back().terms().empty());
+            explain_handler ex;
+            pubgrub::generate_explaination(fail, ex);
+            CHECK(ex.message.str() == "Known: x [2, 3) requires y [1, 2)\n"
+                                      "Known: a [2, 3) requires x [2, 3)\n"
+                                      "Thus: a [2, 3) conflicts with y [2, 3)\n"
+                                      "Known: y [2, 3) is needed\n"
+                                      "Known: a [2, 3) is needed\n"
+                                      "Thus: There is no solution\n");
+        }
+
+        pubgrub::solve_options opts;
+        opts.retain_explanations = false;
+        try {
+            pubgrub::solve_cdcl(roots, repo, opts);
+            FAIL("Expected a failure");
+        } catch (const pubgrub::solve_failure_type_t<simple_req>& fail) {
+            CHECK(fail.incompatibilities().size() == 1);
+        }
+    }
+}
+
+TEST_CASE("CDCL encodes candidates as they are selected") {
+    pubgrub::test::counting_memory_provider repo;
+    repo.add(ver("a", 1), {simple_req{"b", {1, 2}}});
+    repo.add(ver("a", 2), {simple_req{"x", {1, 3}}});
+    repo.add(ver("b", 1), {simple_req{"c", {1, 2}}});
+    repo.add(ver("c", 1), {});
+    repo.add(ver("x", 1), {});
+    repo.add(ver("x", 2), {});
+
+    auto roots = std::vector{simple_req{"a", {1, 3}}, simple_req{"x", {1, 3}}};
+    auto sln   = pubgrub::solve_cdcl(roots, repo);
+    CHECK(sln == std::vector{ver("a", 2), ver("x", 2)});
+    // Two lookups for each root. a=1 is never selected, so b is never looked up, and the
+    // candidates of x are only looked up once.
+    CHECK(repo.n_queries == 4);
+}
+
+TEST_CASE("CDCL commits to its solution") {
+    pubgrub::test::observed_memory_provider repo;
+    repo.add(ver("a", 1), {simple_req{"b", {1, 3}}});
+    repo.add(ver("b", 1), {});
+    repo.add(ver("b", 2), {});
+
+    auto sln = pubgrub::solve_cdcl(std::vector{simple_req{"a", {1, 2}}}, repo);
+    CHECK(repo.committed == sln);
+}
+
+TEST_CASE("CDCL agrees with the regular solver") {
+    using failure_type = pubgrub::solve_failure_type_t<simple_req>;
+    std::mt19937 rng{1729};
+    int          n_solved = 0;
+    int          n_failed = 0;
+    for (int n = 0; n < 300; ++n) {
+        auto [repo, roots] = random_problem(rng, 3 + n % 6);
+        INFO("Problem " << n);
+        bool solvable = true;
+        try {
+            pubgrub::solve(roots, repo);
+        } catch (const failure_type&) {
+            solvable = false;
+        }
+        if (solvable) {
+            CHECK(is_valid_solution(pubgrub::solve_cdcl(roots, repo), roots, repo));
+            ++n_solved;
+            continue;
+        }
+        try {
+            pubgrub::solve_cdcl(roots, repo);
+            FAIL("The regular solver found no solution, but the CDCL engine did");
+        } catch (const failure_type& fail) {
+            CHECK(fail.incompatibilities().back().terms().empty());
+        }
+        ++n_failed;
+    }
+    // The corpus has both outcomes
+    CHECK(n_solved > 0);
+    CHECK(n_failed > 0);
+}
+
+TEST_CASE("Benchmark CDCL against the regular solver", "[.benchmark]") {
+    using clock = std::chrono::steady_clock;
+    std::mt19937    rng{1729};
+    clock::duration times[2] = {};
+    for (int n = 0; n < 200; ++n) {
+        auto [repo, roots] = random_problem(rng, 20);
+        for (int engine = 0; engine < 2; ++engine) {
+            const auto start = clock::now();
+            try {
+                if (engine == 0) {
+                    pubgrub::solve(roots, repo);
+                } else {
+                    pubgrub::solve_cdcl(roots, repo);
+                }
+            } catch (const pubgrub::unsolvable_failure_base&) {
+            }
+            times[engine] += clock::now() - start;
+        }
+    }
+    auto ms = [](clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+    };
+    WARN("Regular solver: " << ms(times[0]) << " ms, CDCL engine: " << ms(times[1]) << " ms");
+}
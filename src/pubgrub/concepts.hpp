@@ -5,6 +5,7 @@
 #include <iterator>
 #include <ranges>
 #include <type_traits>
+#include <utility>
 
 namespace pubgrub {
 
@@ -90,4 +91,94 @@ concept provider = requirement<Req> && requires(const Provider provider, const R
     { provider.requirements_of(requirement) } -> detail::range_of<Req>;
 };
 
+/**
+ * A provider that can cheaply enumerate every candidate that lies within a requirement. Each
+ * candidate must be a requirement that is acceptable to `requirements_of()`.
+ */
+template <typename Provider, typename Req>
+concept enumerating_provider = provider<Provider, Req> && requires(const Provider provider,
+                                                                   const Req requirement) {
+    { provider.candidates_of(requirement) } -> detail::range_of<Req>;
+};
+
+/**
+ * A provider that can offer a pre-validated bundle of pinned candidates that includes a candidate
+ * for a given requirement. Each pin must be a candidate that is acceptable to `requirements_of()`.
+ * The solver only adopts the pin for the requirement, the pins for packages that are already
+ * required, and the pins that these reach through their dependencies, so a bundle may hold many
+ * more pins than any one solution needs.
+ */
+template <typename Provider, typename Req>
+concept bundle_provider = provider<Provider, Req> && requires(const Provider provider,
+                                                              const Req requirement) {
+    { provider.bundle_for(requirement) } -> detail::boolean;
+    { *provider.bundle_for(requirement) } -> detail::range_of<Req>;
+};
+
+/**
+ * A provider that can cheaply count the candidates that lie within a requirement. The count only
+ * needs to be exact when it is one, in which case `best_candidate()` must give that candidate.
+ */
+template <typename Provider, typename Req>
+concept counting_provider = provider<Provider, Req> && requires(const Provider provider,
+                                                                const Req requirement) {
+    { provider.candidate_count(requirement) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * A provider that knows of candidates that can never be part of any solution, such as those found
+ * by `find_dead_versions()`. These are recorded as unavailable incompatibilities before solving.
+ */
+template <typename Provider, typename Req>
+concept known_unavailable_provider = provider<Provider, Req> && requires(const Provider provider) {
+    { provider.known_unavailable() } -> detail::range_of<Req>;
+};
+
+/**
+ * A provider that wants to know about each candidate as soon as the solver has committed to it.
+ * `on_commit()` is called once for each candidate that is certain to be in the solution, if there
+ * is one, and at the end of a successful solve for every remaining candidate of the solution.
+ * Entry points that solve more than once only pass the candidates of the solutions they return.
+ */
+template <typename Provider, typename Req>
+concept commit_observer = provider<Provider, Req> && requires(Provider& provider,
+                                                              const Req requirement) {
+    provider.on_commit(requirement);
+};
+
+/**
+ * A provider that may need to do I/O to answer queries about some packages. `is_cached()` tells
+ * whether the candidates and requirements within a requirement can be had without waiting, and
+ * `prefetch()` asks for them to be loaded in the background. `prefetch()` must not block.
+ */
+template <typename Provider, typename Req>
+concept caching_provider = provider<Provider, Req> && requires(Provider& provider,
+                                                               const Req requirement) {
+    { std::as_const(provider).is_cached(requirement) } -> detail::boolean;
+    provider.prefetch(requirement);
+};
+
+/**
+ * A provider that keeps the conflict activity of packages between solves. `initial_activity()`
+ * seeds the activity of a key the first time the solver looks at it, and `record_activity()` is
+ * given the activity of every key that was looked at once a solve has finished. Keys with more
+ * activity are decided first.
+ */
+template <typename Provider, typename Req>
+concept activity_provider = provider<Provider, Req> && requires(Provider&              provider,
+                                                                const key_type_t<Req> key) {
+    { std::as_const(provider).initial_activity(key) } -> std::convertible_to<double>;
+    provider.record_activity(key, 1.0);
+};
+
+/**
+ * A requirement whose acceptable versions are given by an `interval_set` in its `range` member
+ */
+template <typename R>
+concept interval_requirement = requirement<R> && requires(const R req) {
+    req.range.iter_intervals();
+    req.range.envelope();
+    typename std::remove_cvref_t<decltype(req.range)>::element_type;
+};
+
 }  // namespace pubgrub
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+#include <pubgrub/debug.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace pubgrub {
+
+/**
+ * Find the candidates that can never be part of any solution. A candidate is dead if one of its
+ * dependencies has no candidates at all, or if every candidate of one of its dependencies is dead.
+ * This is computed to a fixed point over every candidate that is reachable from the candidates
+ * within `scope`.
+ *
+ * The dead candidates of each key are merged into as few requirements as possible. These can be
+ * stored alongside the registry and handed back to the solver with `known_unavailable()`, so that
+ * no solve needs to rediscover them.
+ */
+template <requirement_range Range, enumerating_provider<std::ranges::range_value_t<Range>> P>
+auto find_dead_versions(Range&& scope, const P& p) {
+    using requirement_type = std::ranges::range_value_t<Range>;
+    using key_type         = key_type_t<requirement_type>;
+
+    struct candidate {
+        requirement_type req;
+        bool             dead = false;
+        // For each dependency, the number of its candidates not yet known to be dead
+        std::vector<std::size_t> n_live{};
+        // Each (candidate, dependency index) for which this is a candidate of the dependency
+        std::vector<std::pair<std::size_t, std::size_t>> dependents{};
+    };
+
+    std::vector<candidate>                       cands;
+    std::map<key_type, std::vector<std::size_t>> by_key;
+    std::deque<std::size_t>                      unexpanded;
+    std::vector<std::size_t>                     dying;
+
+    auto index_of = [&](const requirement_type& c) {
+        auto& key_cands = by_key[key_of(c)];
+        auto  found     = std::ranges::find_if(key_cands, [&](std::size_t idx) {
+            return cands[idx].req.implied_by(c) && c.implied_by(cands[idx].req);
+        });
+        if (found != key_cands.end()) {
+            return *found;
+        }
+        const auto idx = cands.size();
+        cands.push_back(candidate{c});
+        key_cands.push_back(idx);
+        unexpanded.push_back(idx);
+        return idx;
+    };
+
+    for (const requirement_type& req : scope) {
+        for (const requirement_type& c : p.candidates_of(req)) {
+            index_of(c);
+        }
+    }
+
+    // Find every reachable candidate, and which candidates each of their dependencies rely on
+    while (!unexpanded.empty()) {
+        const auto idx = unexpanded.front();
+        unexpanded.pop_front();
+        const requirement_type cand = cands[idx].req;
+        for (const requirement_type& dep : p.requirements_of(cand)) {
+            if (key_of(dep) == key_of(cand)) {
+                // This is an error in the registry, which the solver will report
+                continue;
+            }
+            const auto  dep_idx = cands[idx].n_live.size();
+            std::size_t n       = 0;
+            for (const requirement_type& c : p.candidates_of(dep)) {
+                cands[index_of(c)].dependents.emplace_back(idx, dep_idx);
+                ++n;
+            }
+            cands[idx].n_live.push_back(n);
+            if (n == 0 && !cands[idx].dead) {
+                cands[idx].dead = true;
+                dying.push_back(idx);
+            }
+        }
+    }
+
+    // Each death may leave a dependency of another candidate with nothing left
+    std::size_t n_dead = 0;
+    while (!dying.empty()) {
+        const auto idx = dying.back();
+        dying.pop_back();
+        ++n_dead;
+        for (auto [dependent, dep_idx] : cands[idx].dependents) {
+            auto& d = cands[dependent];
+            if (--d.n_live[dep_idx] == 0 && !d.dead) {
+                d.dead = true;
+                dying.push_back(dependent);
+            }
+        }
+    }
+    debug::debug(p, "Found {} dead candidates among {} reachable candidates", n_dead, cands.size());
+
+    std::vector<requirement_type> ret;
+    for (const auto& [key, key_cands] : by_key) {
+        std::optional<requirement_type> merged;
+        for (std::size_t idx : key_cands) {
+            const requirement_type& req = cands[idx].req;
+            if (!cands[idx].dead) {
+                continue;
+            }
+            if (!merged) {
+                merged = req;
+            } else if (auto un = merged->union_(req)) {
+                merged = requirement_type(*un);
+            } else {
+                ret.push_back(*merged);
+                merged = req;
+            }
+        }
+        if (merged) {
+            ret.push_back(*merged);
+        }
+    }
+    return ret;
+}
+
+}  // namespace pubgrub
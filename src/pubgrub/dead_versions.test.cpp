@@ -0,0 +1,65 @@
+#include "./dead_versions.hpp"
+
+#include <pubgrub/memory_provider.hpp>
+#include <pubgrub/solve.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+using pubgrub::test::simple_req;
+using pubgrub::test::ver;
+
+namespace {
+
+struct fact_repo : pubgrub::test::counting_memory_provider {
+    std::vector<simple_req> dead;
+
+    const std::vector<simple_req>& known_unavailable() const noexcept { return dead; }
+};
+
+fact_repo make_repo() {
+    fact_repo repo;
+    repo.add(ver("a", 1), {simple_req{"b", {1, 10}}});
+    repo.add(ver("a", 2), {simple_req{"c", {1, 2}}});
+    repo.add(ver("a", 3), {simple_req{"b", {1, 3}}});
+    repo.add(ver("b", 1), {simple_req{"d", {5, 6}}});
+    repo.add(ver("b", 2), {simple_req{"e", {1, 2}}});
+    repo.add(ver("b", 3), {});
+    repo.add(ver("d", 1), {});
+    repo.add(ver("e", 1), {simple_req{"c", {1, 2}}});
+    return repo;
+}
+
+}  // namespace
+
+static_assert(pubgrub::known_unavailable_provider<fact_repo, simple_req>);
+static_assert(
+    !pubgrub::known_unavailable_provider<pubgrub::memory_provider<simple_req>, simple_req>);
+
+TEST_CASE("Find dead versions") {
+    auto repo = make_repo();
+
+    auto dead = pubgrub::find_dead_versions(std::vector{simple_req{"a", {1, 100}}}, repo);
+    // Dead versions of the same package are merged, and d=1 is never reached
+    CHECK(dead == std::vector{simple_req{"a", {2, 4}}, simple_req{"b", {1, 3}}, ver("e", 1)});
+
+    auto none = pubgrub::find_dead_versions(std::vector{simple_req{"d", {1, 100}}}, repo);
+    CHECK(none.empty());
+}
+
+TEST_CASE("Solve with known dead versions") {
+    auto repo = make_repo();
+    auto sln  = pubgrub::solve(std::vector{simple_req{"a", {1, 100}}}, repo);
+    CHECK(sln == std::vector{ver("a", 1), ver("b", 3)});
+    const int n_without_facts = repo.n_queries;
+
+    repo.dead      = pubgrub::find_dead_versions(std::vector{simple_req{"a", {1, 100}}}, repo);
+    repo.n_queries = 0;
+    auto fast_sln  = pubgrub::solve(std::vector{simple_req{"a", {1, 100}}}, repo);
+    CHECK(fast_sln == sln);
+    CHECK(repo.n_queries < n_without_facts);
+
+    // A root that needs a dead version fails without a search
+    CHECK_THROWS_AS(pubgrub::solve(std::vector{simple_req{"a", {2, 4}}}, repo),
+                    pubgrub::unsolvable_failure_base);
+}
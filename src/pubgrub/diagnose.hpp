@@ -0,0 +1,170 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+#include <pubgrub/debug.hpp>
+#include <pubgrub/failure.hpp>
+#include <pubgrub/solve.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace pubgrub {
+
+namespace detail {
+
+using root_index_vec = std::vector<std::size_t>;
+
+inline root_index_vec concat_roots(const root_index_vec& a, std::span<const std::size_t> b) {
+    root_index_vec ret = a;
+    ret.insert(ret.end(), b.begin(), b.end());
+    return ret;
+}
+
+/**
+ * The QuickXplain search for a minimal subset of `candidates` that, along with `background`, is
+ * unsolvable. `conflicts(roots)` must return whether the given roots are unsolvable.
+ */
+template <typename Conflicts>
+root_index_vec quickxplain(Conflicts&                   conflicts,
+                           const root_index_vec&        background,
+                           bool                         background_grew,
+                           std::span<const std::size_t> candidates) {
+    if (background_grew && conflicts(background)) {
+        return {};
+    }
+    if (candidates.size() == 1) {
+        return {candidates.begin(), candidates.end()};
+    }
+    const auto first  = candidates.first(candidates.size() / 2);
+    const auto second = candidates.subspan(first.size());
+
+    auto second_needed = quickxplain(conflicts, concat_roots(background, first), true, second);
+    auto first_needed  = quickxplain(conflicts,
+                                    concat_roots(background, second_needed),
+                                    !second_needed.empty(),
+                                    first);
+    return concat_roots(first_needed, second_needed);
+}
+
+}  // namespace detail
+
+/**
+ * Find a minimal subset of the given roots that cannot be solved together. Removing any one of
+ * the returned requirements would make the rest of them solvable. If all of the roots can be
+ * solved together, returns an empty vector.
+ *
+ * Each probe of a subset runs the same solver with the other roots retracted, so the dependency
+ * incompatibilities and everything learned from them are reused between probes. The search also
+ * begins from only those roots that the first failure was derived from. No candidates are passed
+ * to a commit_observer provider, since no solution is returned.
+ */
+template <requirement_range Range, provider<std::ranges::range_value_t<Range>> P>
+auto minimal_conflicting_roots(Range&& roots, P&& p, const solve_options& opts = {}) {
+    using requirement_type = std::ranges::range_value_t<Range>;
+    std::vector<requirement_type> all_roots(std::ranges::begin(roots), std::ranges::end(roots));
+
+    detail::solver<requirement_type, std::remove_reference_t<P>> solver{p, opts};
+    solver.commits = detail::commit_policy::never;
+    for (auto&& req : all_roots) {
+        solver.preload_root(req);
+    }
+
+    // Solve with only the given roots, and return the roots of the failure if it fails
+    using opt_roots = std::optional<detail::root_index_vec>;
+    auto probe      = [&](const detail::root_index_vec& active) -> opt_roots {
+        solver.retracted_roots.assign(all_roots.size(), true);
+        for (std::size_t idx : active) {
+            solver.retracted_roots[idx] = false;
+        }
+        solver.restart();
+        if (solver.search()) {
+            return std::nullopt;
+        }
+        const auto& support = solver.ics.entry_of(*solver.failed_ic).support;
+        return detail::root_index_vec(support.begin(), support.end());
+    };
+    auto conflicts = [&](const detail::root_index_vec& active) {
+        return probe(active).has_value();
+    };
+
+    std::vector<requirement_type> ret;
+    detail::root_index_vec        everything(all_roots.size());
+    std::iota(everything.begin(), everything.end(), std::size_t(0));
+    auto failure_roots = probe(everything);
+    if (!failure_roots || failure_roots->empty()) {
+        return ret;
+    }
+
+    auto minimal = detail::quickxplain(conflicts, {}, false, *failure_roots);
+    std::ranges::sort(minimal);
+    debug::debug(p, "Found {} minimal conflicting roots", minimal.size());
+    std::ranges::transform(minimal, std::back_inserter(ret), [&](std::size_t idx) {
+        return all_roots[idx];
+    });
+    return ret;
+}
+
+/**
+ * The result of `solve_all_failures()`
+ */
+template <requirement Req>
+struct failure_report {
+    /// A solution for the roots that were not retracted
+    std::vector<Req> solution;
+    /// Every failure that was found, in the order that they were found
+    std::vector<solve_failure_type_t<Req>> failures;
+    /// The roots that were retracted because they were involved in a failure
+    std::vector<Req> retracted_roots;
+};
+
+/**
+ * Solve for the given roots, but instead of stopping at the first failure, retract the roots
+ * that the failure was derived from and carry on solving for the rest. This finds each
+ * independent failure in a single run of the solver, along with a solution for the roots that
+ * remain.
+ *
+ * Everything learned before a failure that does not depend on the retracted roots is kept. A
+ * commit_observer provider is only passed the candidates of the returned solution, once it is
+ * complete, since any root may yet be retracted.
+ */
+template <requirement_range Range, provider<std::ranges::range_value_t<Range>> P>
+auto solve_all_failures(Range&& roots, P&& p, const solve_options& opts = {}) {
+    using requirement_type = std::ranges::range_value_t<Range>;
+    using solver_type      = detail::solver<requirement_type, std::remove_reference_t<P>>;
+    std::vector<requirement_type> all_roots(std::ranges::begin(roots), std::ranges::end(roots));
+
+    solver_type solver{p, opts};
+    solver.commits = detail::commit_policy::at_end;
+    for (auto&& req : all_roots) {
+        solver.preload_root(req);
+    }
+    solver.retracted_roots.assign(all_roots.size(), false);
+
+    failure_report<requirement_type> ret;
+    while (true) {
+        if (solver.search()) {
+            auto sln = solver.sln.completed_solution();
+            ret.solution.assign(sln.begin(), sln.end());
+            break;
+        }
+        ret.failures.push_back(solver.ics.build_failure(*solver.failed_ic));
+        const auto& support = solver.ics.entry_of(*solver.failed_ic).support;
+        if (support.empty()) {
+            // The failure does not depend on any root, so nothing can be solved
+            break;
+        }
+        for (std::size_t idx : support) {
+            debug::debug(p, "Retracting root {}", neo::repr(debug::try_repr{all_roots[idx]}));
+            solver.retracted_roots[idx] = true;
+            ret.retracted_roots.push_back(all_roots[idx]);
+        }
+        solver.restart();
+    }
+    return ret;
+}
+
+}  // namespace pubgrub
@@ -0,0 +1,106 @@
+#include "./diagnose.hpp"
+
+#include <pubgrub/memory_provider.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+using pubgrub::test::simple_req;
+using pubgrub::test::ver;
+
+TEST_CASE("Find a minimal set of conflicting roots") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("a", 1), {simple_req{"x", {1, 2}}});
+    repo.add(ver("b", 1), {simple_req{"x", {2, 3}}});
+    repo.add(ver("c", 1), {simple_req{"x", {1, 3}}});
+    repo.add(ver("d", 1), {});
+    repo.add(ver("x", 1), {});
+    repo.add(ver("x", 2), {});
+
+    SECTION("Two roots conflict through a dependency") {
+        auto roots = std::vector{simple_req{"c", {1, 2}},
+                                 simple_req{"a", {1, 2}},
+                                 simple_req{"d", {1, 2}},
+                                 simple_req{"b", {1, 2}}};
+        auto minimal = pubgrub::minimal_conflicting_roots(roots, repo);
+        CHECK(minimal == std::vector{simple_req{"a", {1, 2}}, simple_req{"b", {1, 2}}});
+    }
+
+    SECTION("A root conflicts with another root directly") {
+        auto roots   = std::vector{simple_req{"d", {1, 2}},
+                                 simple_req{"a", {1, 2}},
+                                 simple_req{"x", {2, 3}},
+                                 simple_req{"c", {1, 2}}};
+        auto minimal = pubgrub::minimal_conflicting_roots(roots, repo);
+        CHECK(minimal == std::vector{simple_req{"a", {1, 2}}, simple_req{"x", {2, 3}}});
+    }
+
+    SECTION("A single unavailable root") {
+        auto roots   = std::vector{simple_req{"a", {1, 2}}, simple_req{"e", {1, 2}}};
+        auto minimal = pubgrub::minimal_conflicting_roots(roots, repo);
+        CHECK(minimal == std::vector{simple_req{"e", {1, 2}}});
+    }
+
+    SECTION("Solvable roots have no conflict") {
+        auto roots = std::vector{simple_req{"a", {1, 2}}, simple_req{"c", {1, 2}}};
+        CHECK(pubgrub::minimal_conflicting_roots(roots, repo).empty());
+    }
+}
+
+TEST_CASE("Find every independent failure") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("a", 1), {simple_req{"x", {1, 2}}});
+    repo.add(ver("b", 1), {simple_req{"x", {2, 3}}});
+    repo.add(ver("c", 1), {simple_req{"x", {1, 3}}});
+    repo.add(ver("d", 1), {});
+    repo.add(ver("x", 1), {});
+    repo.add(ver("x", 2), {});
+
+    auto roots  = std::vector{simple_req{"a", {1, 2}},
+                             simple_req{"c", {1, 2}},
+                             simple_req{"b", {1, 2}},
+                             simple_req{"e", {1, 2}},
+                             simple_req{"d", {1, 2}}};
+    auto report = pubgrub::solve_all_failures(roots, repo);
+    CHECK(report.failures.size() == 2);
+
+    auto by_key = [](auto&& l, auto&& r) { return l.key < r.key; };
+    std::ranges::sort(report.retracted_roots, by_key);
+    CHECK(report.retracted_roots
+          == std::vector{simple_req{"a", {1, 2}},
+                         simple_req{"b", {1, 2}},
+                         simple_req{"e", {1, 2}}});
+    std::ranges::sort(report.solution, by_key);
+    CHECK(report.solution == std::vector{ver("c", 1), ver("d", 1), ver("x", 2)});
+}
+
+TEST_CASE("Report no failures when solvable") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("a", 1), {});
+
+    auto report = pubgrub::solve_all_failures(std::vector{simple_req{"a", {1, 5}}}, repo);
+    CHECK(report.failures.empty());
+    CHECK(report.retracted_roots.empty());
+    CHECK(report.solution == std::vector{ver("a", 1)});
+}
+
+TEST_CASE("Only commit the candidates of the remaining solution") {
+    pubgrub::test::observed_memory_provider repo;
+    repo.add(ver("a", 1), {simple_req{"x", {1, 2}}});
+    repo.add(ver("b", 1), {simple_req{"x", {2, 3}}});
+    repo.add(ver("d", 1), {});
+    repo.add(ver("x", 1), {});
+    repo.add(ver("x", 2), {});
+
+    auto roots
+        = std::vector{simple_req{"a", {1, 2}}, simple_req{"b", {1, 2}}, simple_req{"d", {1, 2}}};
+    CHECK(pubgrub::minimal_conflicting_roots(roots, repo).size() == 2);
+    CHECK(repo.committed.empty());
+
+    // a and b each have a single candidate, but one of them is retracted
+    auto report = pubgrub::solve_all_failures(roots, repo);
+    CHECK(report.failures.size() == 1);
+    CHECK(repo.committed == report.solution);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+#include <pubgrub/debug.hpp>
+#include <pubgrub/failure.hpp>
+#include <pubgrub/solve.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace pubgrub {
+
+/**
+ * Lazily find each distinct solution for a set of root requirements.
+ *
+ * After a solution is returned, it is ruled out with a new incompatibility and the same solver
+ * resumes from the point where the solution was found. Everything the solver has learned is kept,
+ * so finding each later solution is much cheaper than solving from scratch.
+ *
+ * Two solutions are distinct if they decide on a different set of package versions. The first
+ * solution is the same one that `pubgrub::solve` would find.
+ *
+ * A commit_observer provider is passed every candidate of each solution as it is returned, even
+ * those it was passed for an earlier solution. No candidate is passed before its solution is
+ * complete, since any candidate may change in a later solution.
+ *
+ * The provider is held by reference and must outlive the enumerator.
+ */
+template <requirement Req, provider<Req> P>
+class solution_enumerator {
+public:
+    using requirement_type = Req;
+    using provider_type    = P;
+    using solution_type    = std::vector<requirement_type>;
+
+private:
+    detail::solver<requirement_type, provider_type> _solver;
+
+    std::optional<solution_type> _prev;
+    bool                         _done = false;
+
+public:
+    template <requirement_range Range>
+    solution_enumerator(Range&& roots, provider_type& p, const solve_options& opts = {})
+        : _solver{p, opts} {
+        _solver.commits = detail::commit_policy::at_end;
+        debug::debug(p, "Enumerating solutions for: {}", neo::repr(debug::try_repr{roots}));
+        for (auto&& req : roots) {
+            _solver.preload_root(req);
+        }
+    }
+
+    /**
+     * Find the next solution. Returns `nullopt` once every solution has been found.
+     *
+     * If there are no solutions at all, the first call will throw the same unsolvable_failure as
+     * `pubgrub::solve`.
+     */
+    std::optional<solution_type> next() {
+        if (_done) {
+            return std::nullopt;
+        }
+        _solver.committed.clear();
+        if (_prev) {
+            try {
+                _solver.exclude_solution(*_prev);
+                auto sln = _solver.solve();
+                _prev.emplace(sln.begin(), sln.end());
+            } catch (const unsolvable_failure_base&) {
+                _done = true;
+                return std::nullopt;
+            }
+        } else {
+            auto sln = _solver.solve();
+            _prev.emplace(sln.begin(), sln.end());
+        }
+        return _prev;
+    }
+};
+
+template <requirement_range Range, provider<std::ranges::range_value_t<Range>> P>
+auto enumerate_solutions(Range&& roots, P&& p, const solve_options& opts = {}) {
+    return solution_enumerator<std::ranges::range_value_t<Range>, std::remove_reference_t<P>>(
+        roots,
+        p,
+        opts);
+}
+
+}  // namespace pubgrub
@@ -0,0 +1,88 @@
+#include "./enumerate.hpp"
+
+#include <pubgrub/memory_provider.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+using pubgrub::test::simple_req;
+using pubgrub::test::ver;
+
+namespace {
+
+bool same_solution(std::vector<simple_req> a, std::vector<simple_req> b) {
+    auto by_key = [](auto&& l, auto&& r) { return l.key < r.key; };
+    std::ranges::sort(a, by_key);
+    std::ranges::sort(b, by_key);
+    return a == b;
+}
+
+}  // namespace
+
+TEST_CASE("Enumerate every solution") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("foo", 1), {});
+    repo.add(ver("foo", 2), {simple_req{"bar", {2, 3}}});
+    repo.add(ver("bar", 1), {});
+    repo.add(ver("bar", 2), {});
+
+    auto roots = std::vector{simple_req{"foo", {1, 3}}, simple_req{"bar", {1, 3}}};
+    auto first = pubgrub::solve(roots, repo);
+
+    auto                                 solutions = pubgrub::enumerate_solutions(roots, repo);
+    std::vector<std::vector<simple_req>> found;
+    while (auto sln = solutions.next()) {
+        found.push_back(*sln);
+    }
+    CHECK_FALSE(solutions.next());
+
+    REQUIRE(found.size() == 3);
+    CHECK(found.front() == first);
+    for (auto expect : {std::vector{ver("foo", 1), ver("bar", 1)},
+                        std::vector{ver("foo", 1), ver("bar", 2)},
+                        std::vector{ver("foo", 2), ver("bar", 2)}}) {
+        INFO("Expecting solution with foo " << expect[0].range << " and bar " << expect[1].range);
+        CHECK(std::ranges::count_if(found, [&](auto&& sln) { return same_solution(sln, expect); })
+              == 1);
+    }
+}
+
+TEST_CASE("Enumerate solutions of unsolvable roots") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("foo", 1), {simple_req{"bar", {1, 10}}});
+
+    auto solutions = pubgrub::enumerate_solutions(std::vector{simple_req{"foo", {1, 2}}}, repo);
+    CHECK_THROWS_AS(solutions.next(), pubgrub::solve_failure_type_t<simple_req>);
+}
+
+TEST_CASE("Enumerate the solution of empty roots") {
+    pubgrub::memory_provider<simple_req> repo;
+    auto solutions = pubgrub::enumerate_solutions(std::vector<simple_req>{}, repo);
+    CHECK(solutions.next() == std::vector<simple_req>{});
+    CHECK_FALSE(solutions.next());
+}
+
+TEST_CASE("Commit each enumerated solution in full") {
+    pubgrub::test::observed_memory_provider repo;
+    repo.add(ver("foo", 1), {});
+    repo.add(ver("foo", 2), {simple_req{"bar", {2, 3}}});
+    repo.add(ver("bar", 1), {});
+    repo.add(ver("bar", 2), {});
+    repo.add(ver("qux", 1), {});
+
+    auto roots = std::vector{simple_req{"foo", {1, 3}},
+                             simple_req{"bar", {1, 3}},
+                             simple_req{"qux", {1, 2}}};
+    auto solutions = pubgrub::enumerate_solutions(roots, repo);
+    int  n_found   = 0;
+    while (auto sln = solutions.next()) {
+        ++n_found;
+        // Even qux, which is the same in every solution, is only committed with its solution
+        CHECK(same_solution(repo.committed, *sln));
+        repo.committed.clear();
+    }
+    CHECK(n_found == 3);
+    CHECK(repo.committed.empty());
+}
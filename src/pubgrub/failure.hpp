@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <list>
 #include <map>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <utility>
 
@@ -80,8 +82,32 @@ struct compromise {
     const Req& result;
 };
 
+/**
+ * A solution that was already found, and has been excluded so that another can be found.
+ */
+template <requirement Req>
+struct excluded {
+    std::span<const term<Req>> solution;
+};
+
+/**
+ * A run of consecutive dependency premises, where each dependency is the dependent of the next,
+ * summarized as the first dependent and the last dependency.
+ */
+template <requirement Req>
+struct dependency_chain {
+    const Req&  dependent;
+    const Req&  dependency;
+    std::size_t length;
+};
+
 struct separator {};
 
+/**
+ * Sent by a budgeted explanation in place of the premises and conclusions that were cut.
+ */
+struct truncated {};
+
 template <typename Inner>
 struct premise {
     const Inner& value;
@@ -102,6 +128,7 @@ concept handler = requires(T h) {
     h(std::declval<conclusion<unavailable<Requirement>>>());
     h(std::declval<conclusion<needed<Requirement>>>());
     h(std::declval<conclusion<compromise<Requirement>>>());
+    h(std::declval<conclusion<excluded<Requirement>>>());
     h(separator());
     h(std::declval<premise<dependency<Requirement>>>());
     h(std::declval<premise<conflict<Requirement>>>());
@@ -109,6 +136,13 @@ concept handler = requires(T h) {
     h(std::declval<premise<unavailable<Requirement>>>());
     h(std::declval<premise<needed<Requirement>>>());
     h(std::declval<premise<compromise<Requirement>>>());
+    h(std::declval<premise<excluded<Requirement>>>());
+};
+
+template <typename T, typename Requirement>
+concept budgeted_handler = handler<T, Requirement> && requires(T h) {
+    h(truncated());
+    h(std::declval<premise<dependency_chain<Requirement>>>());
 };
 // clang-format on
 
@@ -127,6 +161,9 @@ struct failure_writer {
 
     const std::list<ic_type>& ics = failure.incompatibilities();
 
+    // The number of derived incompatibilities being explained, not counting the root
+    std::size_t _depth = 0;
+
     [[noreturn]] void _die() {
         assert(false && "We hit an unknown edge case while generating the dependency resolution error report. Please report this as a bug!");
     }
@@ -143,7 +180,10 @@ struct failure_writer {
     template <typename Receiver>
     void _transform_ic(const ic_type& ic, Receiver&& r) {
         const auto& terms = ic.terms();
-        if (terms.size() == 2) {
+        if (std::holds_alternative<typename ic_type::excluded_cause>(ic.cause())) {
+            // Every term is a positive term of the solution that was excluded
+            r(explain::excluded<requirement_type>{terms});
+        } else if (terms.size() == 2) {
             if (terms[0].positive != terms[1].positive) {
                 // Two terms where one is negative and the other positive implies a dependency
                 // relation, where one requirement implies a requirement of another.
@@ -206,12 +246,34 @@ struct failure_writer {
     void generate() {
         assert(!ics.empty()
                && "Cannot generate an error report from an empty incompatibility list");
-        _generate_for(ics.back());
+        const ic_type& root = ics.back();
+        if (!is_derived(root)) {
+            // The derivation was not retained, so there is only the conclusion to give
+            _send_conclusion(root);
+            return;
+        }
+        _generate_for_derived(root);
     }
 
     void _generate_for(const ic_type& ic) {
+        if constexpr (requires { handle.done(); }) {
+            if (handle.done()) {
+                // The handler does not want any more output
+                return;
+            }
+        }
         if (is_derived(ic)) {
+            if constexpr (requires { handle.may_explain(_depth); }) {
+                if (!handle.may_explain(_depth)) {
+                    // There is no room left to explain it, so it is given as a premise instead
+                    handle.cut();
+                    _send_premise(ic);
+                    return;
+                }
+            }
+            ++_depth;
             _generate_for_derived(ic);
+            --_depth;
         }
     }
 
@@ -281,6 +343,109 @@ struct failure_writer {
     }
 };
 
+/**
+ * Sits between the failure_writer and a budgeted handler. Collapses chains of dependency premises
+ * and stops the writer once the budget has been spent. The writer only descends into a derivation
+ * while the budget can still pay for the conclusions that it owes on the way back up.
+ */
+template <typename Req, typename Handler>
+struct budgeted_explain_handler {
+    Handler&    inner;
+    std::size_t budget;
+
+    std::size_t n_sent    = 0;
+    std::size_t n_dropped = 0;
+    bool        finishing = false;
+
+    std::optional<explain::dependency_chain<Req>> chain{};
+
+    bool done() const noexcept { return n_dropped != 0; }
+
+    /**
+     * Whether there is room to explain one more derived incompatibility, with `depth` others
+     * already being explained above it. Each of them will need a line for its conclusion, and
+     * this one will need a line for its conclusion and at least one for a premise.
+     */
+    bool may_explain(std::size_t depth) const noexcept { return n_sent + depth + 2 <= budget; }
+
+    /**
+     * Mark where the derivation of a premise was left out
+     */
+    void cut() {
+        _flush();
+        if (!done()) {
+            inner(explain::truncated());
+        }
+    }
+
+    template <typename Item>
+    void _send(const Item& item) {
+        if (finishing) {
+            inner(item);
+        } else if (n_dropped != 0 || n_sent == budget) {
+            ++n_dropped;
+        } else {
+            ++n_sent;
+            inner(item);
+        }
+    }
+
+    void _flush() {
+        if (!chain) {
+            return;
+        }
+        auto c = *chain;
+        chain.reset();
+        if (c.length == 1) {
+            _send(explain::premise<explain::dependency<Req>>{{c.dependent, c.dependency}});
+        } else {
+            _send(explain::premise<explain::dependency_chain<Req>>{c});
+        }
+    }
+
+    void operator()(explain::separator) {
+        if (!done()) {
+            _flush();
+            inner(explain::separator());
+        }
+    }
+
+    void operator()(explain::premise<explain::dependency<Req>> dep) {
+        // The chain only holds if every version allowed by its last dependency needs the next one
+        if (chain && key_of(chain->dependency) == key_of(dep.value.dependent)
+            && dep.value.dependent.implied_by(chain->dependency)) {
+            auto c = *chain;
+            chain.emplace(c.dependent, dep.value.dependency, c.length + 1);
+            return;
+        }
+        _flush();
+        chain.emplace(dep.value.dependent, dep.value.dependency, 1);
+    }
+
+    template <typename Item>
+    void operator()(const Item& item) {
+        _flush();
+        _send(item);
+    }
+
+    /**
+     * Send the last conclusion of the explanation, even if the budget has been spent
+     */
+    template <typename Writer>
+    void finish(Writer& writer, const auto& root) {
+        _flush();
+        if (n_dropped == 0) {
+            return;
+        }
+        if (n_dropped > 1) {
+            // More than just the final conclusion was cut
+            inner(explain::truncated());
+        }
+        finishing = true;
+        writer._send_conclusion(root);
+    }
+};
+
 }  // namespace detail
 
 template <typename IC, explain::handler<typename IC::term_type::requirement_type> Handler>
@@ -289,4 +454,24 @@ void generate_explaination(const unsolvable_failure<IC>& fail, Handler&& h) {
     f.generate();
 }
 
+/**
+ * Generate an explanation of at most `max_lines` premises and conclusions, not including the
+ * final conclusion and `truncated` markers. Consecutive dependency premises that form a chain are
+ * collapsed into a single `dependency_chain` premise. A derived incompatibility that the budget
+ * has no room to explain is given as a premise after a `truncated`, without walking its
+ * derivation. If the budget runs out, the writer stops, sends `truncated`, and then sends the
+ * final conclusion.
+ */
+template <typename IC,
+          explain::budgeted_handler<typename IC::term_type::requirement_type> Handler>
+void generate_explaination(const unsolvable_failure<IC>& fail, Handler&& h, std::size_t max_lines) {
+    using requirement_type = typename IC::term_type::requirement_type;
+    using budget_type
+        = detail::budgeted_explain_handler<requirement_type, std::remove_cvref_t<Handler>>;
+    budget_type                             budget{h, max_lines};
+    detail::failure_writer<IC, budget_type> f{fail, budget};
+    f.generate();
+    budget.finish(f, fail.incompatibilities().back());
+}
+
 }  // namespace pubgrub
\ No newline at end of file
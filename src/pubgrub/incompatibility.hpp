@@ -29,8 +29,16 @@ public:
         const incompatibility& left;
         const incompatibility& right;
     };
-    using cause_type
-        = std::variant<root_cause, unavailable_cause, dependency_cause, conflict_cause>;
+    // Derived by conflict resolution, but the incompatibilities it was derived from were not kept
+    struct learned_cause {};
+    // Rules out a solution that was already found, so that the next one can be found
+    struct excluded_cause {};
+    using cause_type = std::variant<root_cause,
+                                    unavailable_cause,
+                                    dependency_cause,
+                                    conflict_cause,
+                                    learned_cause,
+                                    excluded_cause>;
 
 private:
     term_vec   _terms;
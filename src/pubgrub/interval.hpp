@@ -193,7 +193,26 @@ public:
 
     bool disjoint(const interval_type& iv) const noexcept { return _check(iv, 0); }
 
+    /**
+     * Obtain the smallest single interval that covers the whole set. The set must not be empty.
+     */
+    interval_type envelope() const noexcept {
+        assert(!empty());
+        return interval_type{_points.front(), _points.back()};
+    }
+
     bool contains(const interval_set& other) const noexcept {
+        if (other.empty()) {
+            return true;
+        } else if (empty()) {
+            return false;
+        }
+        // Check the envelopes first: Most comparisons can be answered without a full walk.
+        if (other._points.front() < _points.front() || _points.back() < other._points.back()) {
+            return false;
+        } else if (num_intervals() == 1) {
+            return true;
+        }
         auto other_it = other.iter_intervals();
         return std::all_of(other_it.begin(), other_it.end(), [&](const interval_type& iv) {
             return contains(iv);
@@ -203,6 +222,18 @@ public:
     bool contained_by(const interval_set& other) const noexcept { return other.contains(*this); }
 
     bool disjoint(const interval_set& other) const noexcept {
+        if (empty() || other.empty()) {
+            return true;
+        }
+        if (!(other._points.front() < _points.back())
+            || !(_points.front() < other._points.back())) {
+            // this:  ----%%%%%%%---%%%%---------------
+            // other: ----------------------%%%%%%----
+            return true;
+        } else if (num_intervals() == 1 && other.num_intervals() == 1) {
+            // The envelopes overlap, and each set is its own envelope
+            return false;
+        }
         auto other_it = other.iter_intervals();
         return std::all_of(other_it.begin(), other_it.end(), [&](const interval_type& iv) {
             return disjoint(iv);
@@ -33,6 +33,28 @@ TEST_CASE("Intervals can exclude other intervals") {
     CHECK_FALSE(iv1.disjoint(iv2));
 }
 
+TEST_CASE("Envelopes answer simple relations") {
+    using iv_type = pubgrub::interval_set<int>;
+    auto multi    = iv_type{1, 5}.union_({10, 15});
+    CHECK(multi.envelope().low == 1);
+    CHECK(multi.envelope().high == 15);
+
+    CHECK(multi.disjoint(iv_type{15, 20}));
+    CHECK(multi.disjoint(iv_type{5, 10}));
+    CHECK_FALSE(multi.disjoint(iv_type{4, 10}));
+    CHECK(multi.contains(iv_type{2, 4}));
+    CHECK_FALSE(multi.contains(iv_type{2, 12}));
+    CHECK_FALSE(multi.contains(iv_type{0, 2}));
+    CHECK(iv_type{0, 20}.contains(multi));
+    CHECK_FALSE(iv_type{2, 20}.contains(multi));
+
+    iv_type empty;
+    CHECK(multi.contains(empty));
+    CHECK_FALSE(empty.contains(multi));
+    CHECK(empty.disjoint(multi));
+    CHECK(multi.disjoint(empty));
+}
+
 TEST_CASE("Set operations") {
     using iv_type = pubgrub::interval_set<int>;
     iv_type iv1{1, 10};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+
+#include <neo/assert.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace pubgrub {
+
+/**
+ * A provider over an in-memory registry of package versions.
+ *
+ * Each package version is registered as a candidate requirement that admits exactly that one
+ * version (the lowest point of its range), along with the requirements of that version. Versions
+ * are kept in a sorted array per key, so finding a candidate is a binary search for each interval
+ * of the requirement. The requirements of all versions are stored contiguously.
+ *
+ * The key type of the requirement must be hashable with `std::hash`.
+ */
+template <interval_requirement Req>
+class memory_provider {
+public:
+    using requirement_type = Req;
+    using key_type         = key_type_t<requirement_type>;
+    using version_type =
+        typename std::remove_cvref_t<decltype(std::declval<const Req&>().range)>::element_type;
+
+private:
+    struct package_version {
+        version_type     version;
+        requirement_type candidate;
+        std::size_t      deps_begin;
+        std::size_t      deps_end;
+    };
+
+    using version_vec = std::vector<package_version>;
+
+    std::unordered_map<key_type, version_vec> _packages;
+    std::vector<requirement_type>             _deps;
+
+    static const version_type& _version_of(const requirement_type& cand) noexcept {
+        return cand.range.envelope().low;
+    }
+
+    const version_vec* _versions_for(const key_type& key) const noexcept {
+        auto found = _packages.find(key);
+        if (found == _packages.end()) {
+            return nullptr;
+        }
+        return &found->second;
+    }
+
+public:
+    memory_provider() = default;
+
+    /**
+     * Register a new package version. `candidate` must admit only the version being registered.
+     *
+     * Adding a version invalidates the ranges previously returned by `requirements_of()`.
+     */
+    template <requirement_range Deps>
+    void add(requirement_type candidate, Deps&& deps) {
+        auto&             versions = _packages[key_of(candidate)];
+        const std::size_t begin    = _deps.size();
+        _deps.insert(_deps.end(), std::ranges::begin(deps), std::ranges::end(deps));
+        version_type version = _version_of(candidate);
+        auto         pos     = std::ranges::upper_bound(versions,
+                                                version,
+                                                std::less<>{},
+                                                &package_version::version);
+        neo_assert(expects,
+                   pos == versions.begin() || std::prev(pos)->version < version,
+                   "The same package version was registered more than once",
+                   candidate);
+        versions.insert(pos, package_version{version, std::move(candidate), begin, _deps.size()});
+    }
+
+    void add(requirement_type candidate, std::initializer_list<requirement_type> deps) {
+        add(std::move(candidate), std::span{deps.begin(), deps.size()});
+    }
+
+    /**
+     * Find the candidate with the highest version that is allowed by the given requirement
+     */
+    std::optional<requirement_type> best_candidate(const requirement_type& req) const noexcept {
+        const version_vec* versions = _versions_for(key_of(req));
+        if (!versions) {
+            return std::nullopt;
+        }
+        const package_version* best = nullptr;
+        for (const auto& iv : req.range.iter_intervals()) {
+            // The last version that is below the top of this interval
+            auto after = std::ranges::lower_bound(*versions,
+                                                  iv.high,
+                                                  std::less<>{},
+                                                  &package_version::version);
+            if (after == versions->begin()) {
+                continue;
+            }
+            auto& top = *std::prev(after);
+            if (!(top.version < iv.low)) {
+                // Intervals are sorted, so this is the highest so far
+                best = &top;
+            }
+        }
+        if (!best) {
+            return std::nullopt;
+        }
+        return best->candidate;
+    }
+
+    /**
+     * Obtain the requirements of a candidate that was returned from this provider
+     */
+    std::span<const requirement_type> requirements_of(const requirement_type& cand) const noexcept {
+        const version_vec* versions = _versions_for(key_of(cand));
+        neo_assert(expects,
+                   versions != nullptr,
+                   "Requested the requirements of an unknown package",
+                   cand);
+        const version_type& version = _version_of(cand);
+        auto                found   = std::ranges::lower_bound(*versions,
+                                                  version,
+                                                  std::less<>{},
+                                                  &package_version::version);
+        neo_assert(expects,
+                   found != versions->end() && !(version < found->version),
+                   "Requested the requirements of an unknown package version",
+                   cand);
+        return std::span{_deps}.subspan(found->deps_begin, found->deps_end - found->deps_begin);
+    }
+
+    /**
+     * Obtain every candidate that is allowed by the given requirement, from lowest to highest
+     */
+    std::vector<requirement_type> candidates_of(const requirement_type& req) const {
+        std::vector<requirement_type> ret;
+        const version_vec*            versions = _versions_for(key_of(req));
+        if (!versions) {
+            return ret;
+        }
+        for (const auto& iv : req.range.iter_intervals()) {
+            auto first = std::ranges::lower_bound(*versions,
+                                                  iv.low,
+                                                  std::less<>{},
+                                                  &package_version::version);
+            auto last  = std::ranges::lower_bound(first,
+                                                 versions->end(),
+                                                 iv.high,
+                                                 std::less<>{},
+                                                 &package_version::version);
+            std::ranges::transform(first,
+                                   last,
+                                   std::back_inserter(ret),
+                                   &package_version::candidate);
+        }
+        return ret;
+    }
+};
+
+}  // namespace pubgrub
@@ -0,0 +1,50 @@
+#include "./memory_provider.hpp"
+
+#include <pubgrub/solve.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+using pubgrub::test::simple_req;
+using pubgrub::test::ver;
+
+static_assert(pubgrub::provider<pubgrub::memory_provider<simple_req>, simple_req>);
+static_assert(pubgrub::enumerating_provider<pubgrub::memory_provider<simple_req>, simple_req>);
+
+TEST_CASE("Look up candidates in a memory provider") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("foo", 3), {simple_req{"bar", {1, 5}}});
+    repo.add(ver("foo", 1), {});
+    repo.add(ver("foo", 7), {simple_req{"bar", {2, 3}}, simple_req{"baz", {1, 2}}});
+    repo.add(ver("bar", 2), {});
+
+    CHECK(repo.best_candidate(simple_req{"foo", {1, 100}}) == ver("foo", 7));
+    CHECK(repo.best_candidate(simple_req{"foo", {1, 7}}) == ver("foo", 3));
+    CHECK(repo.best_candidate(simple_req{"foo", {4, 7}}) == std::nullopt);
+    CHECK(repo.best_candidate(simple_req{"nope", {1, 100}}) == std::nullopt);
+    auto split = pubgrub::interval_set<int>{1, 2}.union_({3, 4});
+    CHECK(repo.best_candidate(simple_req{"foo", split}) == ver("foo", 3));
+
+    CHECK(repo.requirements_of(ver("foo", 1)).empty());
+    auto deps = repo.requirements_of(ver("foo", 7));
+    REQUIRE(deps.size() == 2);
+    CHECK(deps[0] == simple_req{"bar", {2, 3}});
+    CHECK(deps[1] == simple_req{"baz", {1, 2}});
+
+    auto cands = repo.candidates_of(simple_req{"foo", {2, 100}});
+    CHECK(cands == std::vector{ver("foo", 3), ver("foo", 7)});
+}
+
+TEST_CASE("Solve against a memory provider") {
+    pubgrub::memory_provider<simple_req> repo;
+    repo.add(ver("foo", 1), {simple_req{"bar", {1, 1000}}});
+    repo.add(ver("foo", 2), {simple_req{"bar", {1, 1000}}, simple_req{"baz", {200, 201}}});
+    repo.add(ver("bar", 100), {});
+    repo.add(ver("bar", 200), {simple_req{"baz", {100, 101}}});
+    repo.add(ver("baz", 100), {});
+    repo.add(ver("baz", 200), {});
+
+    // Every version of "foo" needs "bar", so "bar" is decided first, which then rules out foo=2
+    auto sln = pubgrub::solve(std::vector{simple_req{"foo", {1, 1000}}}, repo);
+    CHECK(sln == std::vector{ver("bar", 200), ver("baz", 100), ver("foo", 1)});
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+#include <pubgrub/debug.hpp>
+#include <pubgrub/solve.hpp>
+
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace pubgrub {
+
+/**
+ * A requirement that can tell whether it only places a lower bound on the versions it accepts
+ */
+template <typename R>
+concept lower_bound_requirement = requirement<R> && requires(const R req) {
+    { req.lower_bound_only() } -> detail::boolean;
+};
+
+/**
+ * Solve for the given roots with a single traversal of the dependency graph, as long as every
+ * requirement that is seen only has a lower bound.
+ *
+ * With only lower bounds, nothing can rule out a candidate that was chosen earlier unless it is
+ * older than a later requirement wants, so each package is visited once and its best candidate is
+ * chosen without any backtracking. If the provider's best candidate is the newest one, this gives
+ * the same solution as `solve()`.
+ *
+ * As soon as a requirement with an upper bound appears, a requirement has no candidate, or a
+ * requirement excludes a candidate that was already chosen, this gives up and runs the regular
+ * solver instead.
+ */
+template <requirement_range Range, provider<std::ranges::range_value_t<Range>> P>
+requires lower_bound_requirement<std::ranges::range_value_t<Range>>
+auto solve_mvs(Range&& roots, P&& p, const solve_options& opts = {}) {
+    using requirement_type = std::ranges::range_value_t<Range>;
+    using key_type         = key_type_t<requirement_type>;
+
+    std::vector<requirement_type> root_reqs(std::ranges::begin(roots), std::ranges::end(roots));
+    debug::debug(p, "Solving lower-bound requirements: {}", neo::repr(debug::try_repr{root_reqs}));
+
+    std::vector<requirement_type> ret;
+    auto                          fall_back = [&](const requirement_type& req) {
+        debug::debug(p,
+                     "Requirement {} cannot be handled by a single traversal. Running the solver.",
+                     neo::repr(debug::try_repr{req}));
+        auto sln = pubgrub::solve(root_reqs, p, opts);
+        ret.assign(sln.begin(), sln.end());
+        return ret;
+    };
+
+    // The index in `ret` of the candidate chosen for each key
+    std::map<key_type, std::size_t> chosen;
+    std::deque<requirement_type>    pending(root_reqs.begin(), root_reqs.end());
+    while (!pending.empty()) {
+        const requirement_type req = std::move(pending.front());
+        pending.pop_front();
+        if (!req.lower_bound_only()) {
+            return fall_back(req);
+        }
+
+        auto found = chosen.find(key_of(req));
+        if (found != chosen.end()) {
+            if (!req.implied_by(ret[found->second])) {
+                return fall_back(req);
+            }
+            continue;
+        }
+
+        auto cand = p.best_candidate(req);
+        if (!cand) {
+            return fall_back(req);
+        }
+        chosen.emplace(key_of(req), ret.size());
+        ret.push_back(*cand);
+        for (const requirement_type& dep : p.requirements_of(ret.back())) {
+            if (key_of(dep) == key_of(req)) {
+                throw std::runtime_error("Package cannot depend on itself.");
+            }
+            pending.push_back(dep);
+        }
+    }
+    return ret;
+}
+
+}  // namespace pubgrub
@@ -0,0 +1,58 @@
+#include "./mvs.hpp"
+
+#include <pubgrub/memory_provider.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <limits>
+
+using pubgrub::test::simple_req;
+using pubgrub::test::ver;
+
+namespace {
+
+simple_req at_least(std::string name, int version) {
+    return simple_req{name, {version, std::numeric_limits<int>::max()}};
+}
+
+auto sorted(std::vector<simple_req> sln) {
+    std::ranges::sort(sln, std::less<>{}, &simple_req::key);
+    return sln;
+}
+
+}  // namespace
+
+static_assert(pubgrub::lower_bound_requirement<simple_req>);
+
+TEST_CASE("Solve lower-bound requirements with a single traversal") {
+    pubgrub::test::counting_memory_provider repo;
+    repo.add(ver("a", 1), {at_least("b", 1)});
+    repo.add(ver("a", 2), {at_least("b", 2), at_least("c", 1)});
+    repo.add(ver("b", 1), {});
+    repo.add(ver("b", 2), {at_least("c", 2)});
+    repo.add(ver("b", 3), {});
+    repo.add(ver("c", 1), {});
+    repo.add(ver("c", 2), {});
+
+    SECTION("Only lower bounds") {
+        auto roots = std::vector{at_least("a", 1), at_least("c", 1)};
+        auto sln   = pubgrub::solve_mvs(roots, repo);
+        CHECK(sorted(sln) == std::vector{ver("a", 2), ver("b", 3), ver("c", 2)});
+        // Each package is only looked up once
+        CHECK(repo.n_queries == 3);
+        CHECK(sorted(sln) == sorted(pubgrub::solve(roots, repo)));
+    }
+
+    SECTION("An upper bound falls back to the solver") {
+        auto roots = std::vector{at_least("a", 1), simple_req{"b", {1, 3}}};
+        auto sln   = pubgrub::solve_mvs(roots, repo);
+        CHECK(sorted(sln) == std::vector{ver("a", 2), ver("b", 2), ver("c", 2)});
+    }
+
+    SECTION("Unsolvable lower bounds give the regular failure") {
+        auto roots = std::vector{at_least("a", 1), at_least("b", 4)};
+        CHECK_THROWS_AS(pubgrub::solve_mvs(roots, repo), pubgrub::solve_failure_type_t<simple_req>);
+    }
+}
@@ -8,6 +8,8 @@
 #include <iostream>
 #include <map>
 #include <numeric>
+#include <optional>
+#include <ranges>
 #include <set>
 #include <stdexcept>
 #include <vector>
@@ -27,7 +29,9 @@ public:
         term_type                   term;
         std::size_t                 decision_level;
         const incompatibility_type* cause;
-        bool                        is_decision() const noexcept { return cause == nullptr; }
+        // Whether this derivation settles its key on the key's sole candidate
+        bool forced = false;
+        bool is_decision() const noexcept { return cause == nullptr; }
 
         friend void do_repr(auto out, const assignment* self) noexcept {
             constexpr bool can_repr_req = decltype(out)::template can_repr<requirement_type>;
@@ -54,17 +58,43 @@ private:
     using term_map           = std::map<key_type, term_type, std::less<>, term_map_alloc_type>;
     using key_allocator_type = detail::rebind_alloc_t<allocator_type, key_type>;
     using key_set            = std::set<key_type, std::less<>, key_allocator_type>;
+    using generation_map_alloc_type
+        = detail::rebind_alloc_t<allocator_type, std::pair<const key_type, std::size_t>>;
+    using generation_map
+        = std::map<key_type, std::size_t, std::less<>, generation_map_alloc_type>;
+    using level_map = std::map<key_type, std::size_t, std::less<>, generation_map_alloc_type>;
+    using index_vec = std::vector<std::size_t, detail::rebind_alloc_t<allocator_type, std::size_t>>;
+    using index_map_alloc_type
+        = detail::rebind_alloc_t<allocator_type, std::pair<const key_type, index_vec>>;
+    using index_map = std::map<key_type, index_vec, std::less<>, index_map_alloc_type>;
 
     allocator_type _alloc;
     assignment_vec _assignments{assignment_allocator_type(_alloc)};
     term_map       _positives{term_map_alloc_type(_alloc)};
     term_map       _negatives{term_map_alloc_type(_alloc)};
     key_set        _decided_keys{key_allocator_type(_alloc)};
+    // Keys settled by a forced derivation, with the decision level of that derivation
+    level_map _forced_keys{generation_map_alloc_type(_alloc)};
+    // Every change to the cached term of a key stamps that key with a new generation
+    std::size_t    _generation = 0;
+    generation_map _generations{generation_map_alloc_type(_alloc)};
+    // The first _n_frozen assignments are at decision level zero, and are permanent. Their
+    // terms are pre-intersected per key in the frozen maps.
+    std::size_t _n_frozen = 0;
+    term_map    _frozen_positives{term_map_alloc_type(_alloc)};
+    term_map    _frozen_negatives{term_map_alloc_type(_alloc)};
+    // The indices of the level-zero assignments of each key, in order
+    index_map _frozen_by_key{index_map_alloc_type(_alloc)};
 
     void _register(const term_type& t) {
+        _generations[t.key()] = ++_generation;
+        _register_into(t, _positives, _negatives);
+    }
+
+    static void _register_into(const term_type& t, term_map& positives, term_map& negatives) {
         neo_assertion_breadcrumbs("Narrowing assignment caches", t);
-        const auto pos_it = _positives.find(t.key());
-        if (pos_it != _positives.end()) {
+        const auto pos_it = positives.find(t.key());
+        if (pos_it != positives.end()) {
             auto opt_is = pos_it->second.intersection(t);
             neo_assert(expects,
                        opt_is.has_value(),
@@ -77,8 +107,8 @@ private:
         }
 
         auto term   = t;
-        auto neg_it = _negatives.find(term.key());
-        if (neg_it != _negatives.end()) {
+        auto neg_it = negatives.find(term.key());
+        if (neg_it != negatives.end()) {
             auto opt_t = t.intersection(neg_it->second);
             neo_assert(expects,
                        opt_t.has_value(),
@@ -90,36 +120,67 @@ private:
         }
 
         if (term.positive) {
-            if (neg_it != _negatives.end()) {
+            if (neg_it != negatives.end()) {
                 // Remove the assignment from the negatives list
-                _negatives.erase(neg_it);
+                negatives.erase(neg_it);
             }
             neo_assert(invariant,
-                       _positives.find(t.key()) == _positives.end(),
+                       positives.find(t.key()) == positives.end(),
                        "Positive term was not inserted as the final element in the positives list",
                        term);
-            _positives.emplace(t.key(), std::move(term));
+            positives.emplace(t.key(), std::move(term));
         } else {
-            _negatives.insert_or_assign(t.key(), std::move(term));
+            negatives.insert_or_assign(t.key(), std::move(term));
         }
     }
 
-    static set_relation _relation_to(const term_type& term,
-                                     const term_map&  positives,
-                                     const term_map&  negatives) noexcept {
-        auto pos_it = positives.find(term.key());
+    static const term_type* _term_for(const key_type& key,
+                                      const term_map&  positives,
+                                      const term_map&  negatives) noexcept {
+        auto pos_it = positives.find(key);
         if (pos_it != positives.end()) {
-            return pos_it->second.relation_to(term);
+            return &pos_it->second;
         }
 
-        auto neg_it = negatives.find(term.key());
+        auto neg_it = negatives.find(key);
         if (neg_it != negatives.end()) {
-            return neg_it->second.relation_to(term);
+            return &neg_it->second;
         }
 
+        return nullptr;
+    }
+
+    static set_relation _relation_to(const term_type& term,
+                                     const term_map&  positives,
+                                     const term_map&  negatives) noexcept {
+        auto found = _term_for(term.key(), positives, negatives);
+        if (found) {
+            return found->relation_to(term);
+        }
         return set_relation::overlap;
     }
 
+    void _record(assignment&& as) {
+        auto& inserted = _assignments.emplace_back(std::move(as));
+        _register(inserted.term);
+        if (inserted.decision_level == 0) {
+            // Assignments at level zero can never be undone. Keep their combined terms aside so
+            // that we never need to replay or scan them again.
+            neo_assert(invariant,
+                       _n_frozen + 1 == _assignments.size(),
+                       "Level-zero assignment was recorded after a decision",
+                       inserted);
+            _n_frozen = _assignments.size();
+            _register_into(inserted.term, _frozen_positives, _frozen_negatives);
+            _frozen_by_key.try_emplace(inserted.term.key(), index_vec(_alloc))
+                .first->second.push_back(_n_frozen - 1);
+        }
+    }
+
+    auto _unfrozen() const noexcept {
+        return std::ranges::subrange(_assignments.cbegin() + _n_frozen, _assignments.cend());
+    }
+
 public:
     partial_solution() = default;
     explicit partial_solution(allocator_type alloc)
@@ -127,9 +188,12 @@ public:
 
     std::vector<requirement_type, allocator_type> completed_solution() const noexcept {
         std::vector<requirement_type, allocator_type> ret{_alloc};
+        // Forced derivations may be at level zero, so we cannot skip the frozen prefix
         for (const assignment& as : _assignments) {
             if (as.is_decision()) {
                 ret.push_back(as.term.requirement);
+            } else if (as.forced) {
+                ret.push_back(*positive_requirement(as.term.key()));
             }
         }
         return ret;
@@ -137,9 +201,18 @@ public:
 
     void record_derivation(term_type term, const incompatibility_type& cause) noexcept {
         neo_assertion_breadcrumbs("Recording new derivation", term, cause);
-        auto& inserted
-            = _assignments.emplace_back(assignment{std::move(term), _decided_keys.size(), &cause});
-        _register(inserted.term);
+        _record(assignment{std::move(term), _decided_keys.size(), &cause});
+    }
+
+    /**
+     * Record a derivation that narrows the term for its key down to the only candidate of that
+     * key. The key is then settled just as if the candidate had been decided, but no new decision
+     * level is opened.
+     */
+    void record_forced_derivation(term_type term, const incompatibility_type& cause) noexcept {
+        neo_assertion_breadcrumbs("Recording new forced derivation", term, cause);
+        _forced_keys.insert_or_assign(term.key(), _decided_keys.size());
+        _record(assignment{std::move(term), _decided_keys.size(), &cause, true});
     }
 
     void record_decision(term_type term) noexcept {
@@ -147,10 +220,8 @@ public:
         [[maybe_unused]] const auto did_insert = _decided_keys.emplace(term.key()).second;
         assert(did_insert && "More than one decision recorded for a single item");
 
-        auto& inserted
-            = _assignments.emplace_back(assignment{std::move(term), _decided_keys.size(), nullptr});
-        assert(inserted.term.positive);
-        _register(inserted.term);
+        assert(term.positive);
+        _record(assignment{std::move(term), _decided_keys.size(), nullptr});
     }
 
     bool satisfies(const term_type& term) const noexcept {
@@ -161,11 +232,57 @@ public:
         return _relation_to(term, _positives, _negatives);
     }
 
+    /**
+     * Obtain the positive requirement that the partial solution currently holds for the given key,
+     * or `nullptr` if there is no positive assignment for that key.
+     */
+    const requirement_type* positive_requirement(const key_type& k) const noexcept {
+        auto pos_it = _positives.find(k);
+        if (pos_it == _positives.end()) {
+            return nullptr;
+        }
+        return &pos_it->second.requirement;
+    }
+
+    bool is_decided(const key_type& k) const noexcept { return _decided_keys.contains(k); }
+
+    /// The number of decisions in the partial solution
+    std::size_t decision_level() const noexcept { return _decided_keys.size(); }
+
+    /// Whether the given key has been decided or forced onto its only candidate
+    bool is_settled(const key_type& k) const noexcept {
+        return is_decided(k) || _forced_keys.contains(k);
+    }
+
+    /**
+     * Obtain the generation of the cached term for the given key. The generation changes every
+     * time the term for the key is narrowed or the partial solution is backtracked, so an
+     * unchanged generation means that relations against that key's term are also unchanged.
+     */
+    std::size_t generation_of(const key_type& k) const noexcept {
+        auto gen_it = _generations.find(k);
+        if (gen_it == _generations.end()) {
+            return 0;
+        }
+        return gen_it->second;
+    }
+
+    /**
+     * Obtain a view of every positive requirement whose key has not yet been settled, in the
+     * order that `next_unsatisfied_term()` would consider them.
+     */
+    auto unsatisfied_terms() const noexcept {
+        return _positives  //
+            | std::views::filter([this](auto&& pair) { return !is_settled(pair.first); })
+            | std::views::transform(
+                   [](auto&& pair) -> const requirement_type& { return pair.second.requirement; });
+    }
+
     const requirement_type* next_unsatisfied_term() const noexcept {
-        // Find the first positive term which has a key that has not already been decided
+        // Find the first positive term which has a key that has not already been settled
         auto found = std::ranges::find_if_not(
             _positives,
-            [&](auto&& key) { return _decided_keys.contains(key); },
+            [&](auto&& key) { return is_settled(key); },
             [&](auto&& pair) { return pair.second.key(); });
         if (found != _positives.cend()) {
             return &found->second.requirement;
@@ -181,10 +298,16 @@ public:
         while (_assignments.back().decision_level > decision_level) {
             _assignments.pop_back();
         }
-        _positives.clear();
-        _negatives.clear();
+        // Restart from the level-zero facts rather than replaying them
+        _positives = _frozen_positives;
+        _negatives = _frozen_negatives;
         _decided_keys.clear();
-        for (const auto& as : _assignments) {
+        std::erase_if(_forced_keys, [&](auto&& pair) { return pair.second > decision_level; });
+        // Keys that are no longer assigned must not keep a generation matching a stale term
+        for (auto& [key, gen] : _generations) {
+            gen = ++_generation;
+        }
+        for (const auto& as : _unfrozen()) {
             _register(as.term);
             if (as.is_decision()) {
                 _decided_keys.insert(as.term.key());
@@ -195,7 +318,22 @@ public:
     const assignment& satisfier_of(const term_type& term) const noexcept {
         std::optional<term_type> assigned_term;
 
-        for (const assignment& as : _assignments) {
+        // If the permanent facts alone satisfy the term, only the level-zero assignments of its key
+        // need to be visited. Otherwise begin the scan after the prefix with the combined
+        // level-zero term for the key.
+        if (_relation_to(term, _frozen_positives, _frozen_negatives) == set_relation::subset) {
+            for (std::size_t idx : _frozen_by_key.find(term.key())->second) {
+                const assignment& as = _assignments[idx];
+                assigned_term = assigned_term ? assigned_term->intersection(as.term) : as.term;
+                if (assigned_term->implies(term)) {
+                    return as;
+                }
+            }
+        } else if (auto frozen = _term_for(term.key(), _frozen_positives, _frozen_negatives)) {
+            assigned_term = *frozen;
+        }
+
+        for (const assignment& as : _unfrozen()) {
             if (as.term.key() != term.key()) {
                 continue;
             }
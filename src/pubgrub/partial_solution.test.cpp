@@ -22,3 +22,66 @@ TEST_CASE("Record a basic term") {
     CHECK_FALSE(sln.satisfies(simple_term{{"foo", {12, 13}}}));
     CHECK(sln.satisfies(simple_term{{"foo", {5, 6}}}));
 }
+
+TEST_CASE("Generations change with the terms of a key") {
+    pubgrub::partial_solution<pubgrub::test::simple_req> sln;
+
+    using pubgrub::test::simple_term;
+    pubgrub::incompatibility<pubgrub::test::simple_req> dummy_ic;
+    CHECK(sln.generation_of("foo") == 0);
+    sln.record_derivation(simple_term{{"foo", {1, 10}}}, dummy_ic);
+    const auto foo_gen = sln.generation_of("foo");
+    CHECK(foo_gen != 0);
+
+    sln.record_decision(simple_term{{"bar", {5, 6}}});
+    CHECK(sln.generation_of("foo") == foo_gen);
+    const auto bar_gen = sln.generation_of("bar");
+    CHECK(bar_gen != 0);
+
+    sln.backtrack_to(0);
+    CHECK(sln.generation_of("foo") != foo_gen);
+    CHECK(sln.generation_of("bar") != bar_gen);
+}
+
+TEST_CASE("Level-zero assignments survive backtracking") {
+    pubgrub::partial_solution<pubgrub::test::simple_req> sln;
+
+    using pubgrub::test::simple_term;
+    pubgrub::incompatibility<pubgrub::test::simple_req> dummy_ic;
+    sln.record_derivation(simple_term{{"foo", {1, 10}}}, dummy_ic);
+    sln.record_derivation(simple_term{{"foo", {5, 6}}, false}, dummy_ic);
+    sln.record_decision(simple_term{{"bar", {3, 4}}});
+    sln.record_derivation(simple_term{{"foo", {1, 3}}}, dummy_ic);
+
+    CHECK(sln.satisfies(simple_term{{"foo", {1, 3}}}));
+    CHECK(sln.satisfier_of(simple_term{{"foo", {1, 3}}}).decision_level == 1);
+    const auto& frozen_sat = sln.satisfier_of(simple_term{{"foo", {5, 6}}, false});
+    CHECK(frozen_sat.decision_level == 0);
+    CHECK(frozen_sat.term == simple_term{{"foo", {5, 6}}, false});
+
+    sln.backtrack_to(0);
+    CHECK_FALSE(sln.satisfies(simple_term{{"foo", {1, 3}}}));
+    CHECK(sln.satisfies(simple_term{{"foo", {1, 10}}}));
+    CHECK(sln.satisfies(simple_term{{"foo", {5, 6}}, false}));
+    CHECK(sln.relation_to(simple_term{{"bar", {3, 4}}}) == pubgrub::set_relation::overlap);
+    CHECK(sln.satisfier_of(simple_term{{"foo", {1, 10}}}).term
+          == simple_term{{"foo", {1, 10}}});
+}
+
+TEST_CASE("Find the satisfier among the level-zero assignments of a key") {
+    pubgrub::partial_solution<pubgrub::test::simple_req> sln;
+
+    using pubgrub::test::simple_term;
+    pubgrub::incompatibility<pubgrub::test::simple_req> dummy_ic;
+    sln.record_derivation(simple_term{{"foo", {1, 10}}}, dummy_ic);
+    sln.record_derivation(simple_term{{"baz", {1, 5}}}, dummy_ic);
+    sln.record_derivation(simple_term{{"foo", {5, 10}}, false}, dummy_ic);
+    sln.record_derivation(simple_term{{"baz", {2, 5}}}, dummy_ic);
+    sln.record_decision(simple_term{{"bar", {3, 4}}});
+
+    CHECK(sln.satisfier_of(simple_term{{"foo", {1, 20}}}).term == simple_term{{"foo", {1, 10}}});
+    CHECK(sln.satisfier_of(simple_term{{"foo", {1, 6}}}).term
+          == simple_term{{"foo", {5, 10}}, false});
+    CHECK(sln.satisfier_of(simple_term{{"baz", {1, 2}}, false}).term
+          == simple_term{{"baz", {2, 5}}});
+}
@@ -5,19 +5,55 @@
 #include <pubgrub/failure.hpp>
 #include <pubgrub/incompatibility.hpp>
 #include <pubgrub/partial_solution.hpp>
+#include <pubgrub/stabbing_index.hpp>
 #include <pubgrub/term.hpp>
 
 #include <neo/tl.hpp>
 
+#include <algorithm>
 #include <initializer_list>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <list>
+#include <map>
+#include <optional>
 #include <set>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace pubgrub {
 
+/**
+ * Options to tune the behavior of the solver. The defaults give the classic PubGrub behavior.
+ */
+struct solve_options {
+    /**
+     * If conflict resolution would backjump over more than this many decision levels, backtrack
+     * only a single level instead. The learned incompatibility is kept either way, but the later
+     * decisions (and the provider queries and propagation that went into them) are not discarded
+     * just to be redone.
+     */
+    std::size_t chronological_backtrack_threshold = std::numeric_limits<std::size_t>::max();
+
+    /**
+     * Propagate in rounds: Take every changed key at once, and check each incompatibility that
+     * mentions any of them exactly once per round, in the order they were recorded. Otherwise, an
+     * incompatibility that mentions several changed keys is checked once for each of them.
+     */
+    bool batched_propagation = false;
+
+    /**
+     * Keep every incompatibility derived during conflict resolution so that a failure can explain
+     * itself. If disabled, only the final incompatibility learned from each conflict is recorded,
+     * and a failure carries only the incompatibility that proved it. Its explanation is then just
+     * the conclusion that there is no solution.
+     */
+    bool retain_explanations = true;
+};
+
 namespace detail {
 
 namespace sr = std::ranges;
@@ -31,8 +67,11 @@ class ic_record<pubgrub::incompatibility<Requirement, Allocator>> {
     using allocator_type      = Allocator;
     using ic_type             = incompatibility<requirement_type, allocator_type>;
     using conflict_cause_type = typename ic_type::conflict_cause;
+    using learned_cause_type  = typename ic_type::learned_cause;
+    using root_cause_type     = typename ic_type::root_cause;
 
     using term_type = typename ic_type::term_type;
+    using term_vec  = typename ic_type::term_vec;
     using key_type  = typename term_type::key_type;
 
     template <typename T>
@@ -46,15 +85,44 @@ class ic_record<pubgrub::incompatibility<Requirement, Allocator>> {
         ic_ref_vec ics;
     };
 
+public:
+    using generation_vec = std::vector<std::size_t, rebind_alloc_t<std::size_t>>;
+    using support_vec    = std::vector<std::size_t, rebind_alloc_t<std::size_t>>;
+
+    /**
+     * Every incompatibility in the record is stored along with some bookkeeping for the solver.
+     */
+    struct entry : ic_type {
+        using ic_type::ic_type;
+
+        // The partial solution generations of the keys of our terms at the time that we last found
+        // that this incompatibility could neither conflict nor derive. Empty if unknown.
+        mutable generation_vec inert_generations;
+        // Whether this incompatibility is implied by another and has been dropped from the
+        // propagation lists. It remains available to explain failures.
+        bool retired = false;
+        // The sorted indices of the root incompatibilities that this incompatibility was derived
+        // from. Root incompatibilities are numbered in the order that they are recorded.
+        support_vec support;
+        // The order in which this incompatibility was recorded
+        std::size_t seq = 0;
+        // The last batched propagation round that included this incompatibility
+        mutable std::size_t visit_stamp = 0;
+    };
+
+private:
     allocator_type _alloc;
 
     // Use std::list so elements to not move after creations
-    using list_type = std::list<ic_type, rebind_alloc_t<ic_type>>;
+    using list_type = std::list<entry, rebind_alloc_t<entry>>;
     list_type _ics{_alloc};
 
     using ic_by_key_seq_vec = std::vector<ic_by_key_seq, rebind_alloc_t<ic_by_key_seq>>;
     ic_by_key_seq_vec _by_key{_alloc};
 
+    std::size_t _n_roots    = 0;
+    std::size_t _n_recorded = 0;
+
     auto _seq_for_key(const key_type& key_) const noexcept {
         return sr::partition_point(_by_key, [&](auto&& el) { return el.key < key_; });
     }
@@ -63,31 +131,117 @@ class ic_record<pubgrub::incompatibility<Requirement, Allocator>> {
         return sr::partition_point(_by_key, [&](auto&& el) { return el.key < key_; });
     }
 
-    const ic_type& _add_ic_to_err(std::list<ic_type>& ics, const ic_type& ic) noexcept {
-        auto cause    = ic.cause();
-        auto conflict = std::get_if<conflict_cause_type>(&cause);
+    using copy_map = std::map<const ic_type*, const ic_type*>;
+
+    // Copy an incompatibility and its derivation into a failure. An incompatibility that appears
+    // more than once in the derivation is only copied the first time.
+    const ic_type&
+    _add_ic_to_err(std::list<ic_type>& ics, copy_map& copies, const ic_type& ic) noexcept {
+        auto found = copies.find(&ic);
+        if (found != copies.end()) {
+            return *found->second;
+        }
+        auto           conflict = std::get_if<conflict_cause_type>(&ic.cause());
+        const ic_type* copy     = nullptr;
         if (conflict) {
-            const ic_type& left  = _add_ic_to_err(ics, conflict->left);
-            const ic_type& right = _add_ic_to_err(ics, conflict->right);
-            return ics.emplace_back(ic.terms(), _alloc, conflict_cause_type{left, right});
+            const ic_type& left  = _add_ic_to_err(ics, copies, conflict->left);
+            const ic_type& right = _add_ic_to_err(ics, copies, conflict->right);
+            copy = &ics.emplace_back(ic.terms(), _alloc, conflict_cause_type{left, right});
         } else {
-            return ics.emplace_back(ic.terms(), _alloc, ic.cause());
+            copy = &ics.emplace_back(ic.terms(), _alloc, ic.cause());
         }
+        copies.emplace(&ic, copy);
+        return *copy;
     }
 
-    unsolvable_failure<ic_type> _build_exception(const ic_type& root) noexcept {
-        std::list<ic_type> ics;
-        _add_ic_to_err(ics, root);
-        return unsolvable_failure<ic_type>(std::move(ics));
+    /**
+     * Determine whether `general` makes `specific` redundant: Every term of `general` is implied
+     * by the term in `specific` of the same key, so `general` is satisfied whenever `specific` is.
+     * `general` must also not depend on any root that `specific` does not, or else retracting that
+     * root would lose information.
+     */
+    static bool _subsumes(const ic_type& general, const ic_type& specific) noexcept {
+        if (&general == &specific || general.terms().size() > specific.terms().size()) {
+            return false;
+        }
+        if (!sr::includes(entry_of(specific).support, entry_of(general).support)) {
+            return false;
+        }
+        // Terms are sorted by key, so we can walk the two term lists together
+        auto       spec_it  = specific.terms().cbegin();
+        const auto spec_end = specific.terms().cend();
+        for (const term_type& gen_term : general.terms()) {
+            spec_it = std::find_if(spec_it, spec_end, [&](const term_type& t) {
+                return !(t.key() < gen_term.key());
+            });
+            if (spec_it == spec_end || spec_it->key() != gen_term.key()
+                || !spec_it->implies(gen_term)) {
+                return false;
+            }
+        }
+        return true;
     }
 
-public:
-    explicit ic_record(allocator_type ac)
-        : _alloc(ac) {}
+    // Everything in the propagation lists was created by us and is not actually const
+    static entry& _owned_entry(const ic_type& ic) noexcept {
+        return const_cast<entry&>(entry_of(ic));
+    }
 
-    template <typename... Args>
-    ic_type& emplace_record(Args&&... args) noexcept {
-        auto& new_ic = _ics.emplace_back(std::forward<Args>(args)...);
+    bool _is_redundant(const ic_type& new_ic) const noexcept {
+        // A subsuming incompatibility only mentions our keys, so it will be listed for at least
+        // one of them
+        return sr::any_of(new_ic.terms(), [&](const term_type& term) {
+            auto seq = _seq_for_key(term.key());
+            if (seq == _by_key.end() || seq->key != term.key()) {
+                return false;
+            }
+            return sr::any_of(seq->ics, [&](const ic_type& existing) {
+                return _subsumes(existing, new_ic);
+            });
+        });
+    }
+
+    void _retire_subsumed_by(const ic_type& new_ic) {
+        if (new_ic.terms().empty()) {
+            return;
+        }
+        // Anything that we subsume must mention all of our keys. Look for candidates in the
+        // shortest list.
+        auto shortest = _by_key.end();
+        for (const term_type& term : new_ic.terms()) {
+            auto seq = _seq_for_key(term.key());
+            if (seq == _by_key.end() || seq->key != term.key()) {
+                return;
+            }
+            if (shortest == _by_key.end() || seq->ics.size() < shortest->ics.size()) {
+                shortest = seq;
+            }
+        }
+
+        ic_ref_vec retiring{_alloc};
+        sr::copy_if(shortest->ics, std::back_inserter(retiring), [&](const ic_type& existing) {
+            return _subsumes(new_ic, existing);
+        });
+        for (const ic_type& old_ic : retiring) {
+            _owned_entry(old_ic).retired = true;
+            for (const term_type& term : old_ic.terms()) {
+                auto seq = _seq_for_key(term.key());
+                std::erase_if(seq->ics, [&](const ic_type& ic) { return &ic == &old_ic; });
+            }
+        }
+    }
+
+    // Number a new incompatibility and add it to the propagation lists
+    entry& _file(entry& new_ic) noexcept {
+        new_ic.seq = _n_recorded++;
+        if (std::holds_alternative<conflict_cause_type>(new_ic.cause())
+            || std::holds_alternative<learned_cause_type>(new_ic.cause())) {
+            if (_is_redundant(new_ic)) {
+                new_ic.retired = true;
+                return new_ic;
+            }
+            _retire_subsumed_by(new_ic);
+        }
 
         for (const term_type& term : new_ic.terms()) {
             auto existing = _seq_for_key(term.key());
@@ -99,15 +253,104 @@ public:
         return new_ic;
     }
 
+public:
+    explicit ic_record(allocator_type ac)
+        : _alloc(ac) {}
+
+    /**
+     * Record a new incompatibility. If the new incompatibility was derived during conflict
+     * resolution and is implied by one that we already propagate, it will not be added to the
+     * propagation lists. Any existing incompatibilities that the new one implies will be retired
+     * from the propagation lists.
+     */
+    template <typename... Args>
+    ic_type& emplace_record(Args&&... args) noexcept {
+        auto& new_ic = _ics.emplace_back(std::forward<Args>(args)...);
+        if (std::holds_alternative<root_cause_type>(new_ic.cause())) {
+            new_ic.support.push_back(_n_roots++);
+        } else if (auto conflict = std::get_if<conflict_cause_type>(&new_ic.cause())) {
+            sr::set_union(entry_of(conflict->left).support,
+                          entry_of(conflict->right).support,
+                          std::back_inserter(new_ic.support));
+        }
+        return _file(new_ic);
+    }
+
+    /**
+     * Record an incompatibility that was derived by conflict resolution without recording the
+     * incompatibilities it was derived from. It is given the support of everything that it was
+     * derived from, and is otherwise treated the same as a `conflict_cause` incompatibility.
+     */
+    ic_type& emplace_learned(const term_vec& terms, support_vec support) noexcept {
+        auto& new_ic   = _ics.emplace_back(terms, _alloc, learned_cause_type{});
+        new_ic.support = std::move(support);
+        return _file(new_ic);
+    }
+
     const auto& all() const noexcept { return _ics; }
 
+    /**
+     * Obtain the record entry of an incompatibility. The incompatibility must have been created by
+     * this record.
+     */
+    static const entry& entry_of(const ic_type& ic) noexcept {
+        return static_cast<const entry&>(ic);
+    }
+
+    /**
+     * Discard the memoized results of conflict checks. This must be called if the partial solution
+     * is replaced, since its generations will start over.
+     */
+    void forget_memos() const noexcept {
+        for (const entry& e : _ics) {
+            e.inert_generations.clear();
+        }
+    }
+
     const auto& for_name(const key_type& k) const noexcept {
         auto seq_iter = _seq_for_key(k);
         assert(seq_iter != _by_key.cend());
         return seq_iter->ics;
     }
 
-    [[noreturn]] void throw_failure(const ic_type& root) { throw _build_exception(root); }
+    /**
+     * Build the failure that is proven by the given incompatibility, along with a copy of every
+     * incompatibility it was derived from. Each is copied once, however often it was used.
+     */
+    unsolvable_failure<ic_type> build_failure(const ic_type& root) noexcept {
+        std::list<ic_type> ics;
+        copy_map           copies;
+        _add_ic_to_err(ics, copies, root);
+        return unsolvable_failure<ic_type>(std::move(ics));
+    }
+
+    [[noreturn]] void throw_failure(const ic_type& root) { throw build_failure(root); }
+};
+
+template <typename IC>
+struct stabbing_index_for {
+    // Used in place of an index when the requirements do not have interval ranges
+    struct type {
+        explicit type(const auto&) noexcept {}
+    };
+};
+
+template <typename IC>
+requires interval_requirement<typename IC::term_type::requirement_type>
+struct stabbing_index_for<IC> {
+    using type = stabbing_index<IC>;
+};
+
+/**
+ * When a solver passes candidates to a commit_observer
+ */
+enum class commit_policy {
+    /// As soon as each candidate is final, and the rest of the solution once the solve completes
+    early,
+    /// Only the candidates of a complete solution, once the solve completes
+    at_end,
+    /// Never. For searches whose solutions are not handed back to the caller.
+    never,
 };
 
 template <requirement Req, provider<Req> P, typename Allocator = std::allocator<Req>>
@@ -124,7 +367,14 @@ struct solver {
     template <typename T>
     using rebind_alloc = detail::rebind_alloc_t<allocator_type, T>;
 
-    using key_set_type = std::set<key_type, std::less<>, rebind_alloc<key_type>>;
+    using key_set_type    = std::set<key_type, std::less<>, rebind_alloc<key_type>>;
+    using ic_ref          = std::reference_wrapper<const ic_type>;
+    using ic_ref_vec      = std::vector<ic_ref, rebind_alloc<ic_ref>>;
+    using stab_index_type = typename stabbing_index_for<ic_type>::type;
+    using activity_map    = std::map<key_type,
+                                  double,
+                                  std::less<>,
+                                  rebind_alloc<std::pair<const key_type, double>>>;
     struct conflict {};
     struct no_conflict {};
     struct almost_conflict {
@@ -134,12 +384,37 @@ struct solver {
     using conflict_result = std::variant<conflict, no_conflict, almost_conflict>;
 
     provider_type& provider;
+    solve_options  options{};
 
     allocator_type alloc{};
 
     ic_record<ic_type> ics{alloc};
     key_set_type       changed = key_set_type(rebind_alloc<key_type>(alloc));
     sln_type           sln{alloc};
+    // Keys for which we have already looked for dependencies common to all candidates
+    key_set_type common_deps_done = key_set_type(rebind_alloc<key_type>(alloc));
+    // Indices of root incompatibilities that are ignored, along with everything derived from them
+    std::vector<bool, rebind_alloc<bool>> retracted_roots{rebind_alloc<bool>(alloc)};
+    // The incompatibility that proved the failure of the most recent solve, if it failed
+    const ic_type* failed_ic = nullptr;
+    // The number of rounds of batched propagation so far
+    std::size_t propagation_round = 0;
+    // Finds the incompatibilities that might be affected by a key's term in the partial solution
+    stab_index_type stab_index{alloc};
+    // Whether the provider's known-unavailable candidates have been recorded
+    bool known_unavailable_loaded = false;
+    // Keys whose candidates have been passed to the provider's on_commit()
+    key_set_type committed = key_set_type(rebind_alloc<key_type>(alloc));
+    // When candidates are passed to on_commit(). A candidate that is final in one solve is not
+    // final if a later solve can retract its roots or exclude its solution.
+    commit_policy commits = commit_policy::early;
+    // Keys that the provider has been asked to prefetch
+    key_set_type prefetched = key_set_type(rebind_alloc<key_type>(alloc));
+    // The conflict activity of each key that has been looked at, and the amount that the next
+    // conflict adds to the activity of its keys. The increment grows so that older conflicts
+    // count for less.
+    activity_map activity = activity_map(rebind_alloc<std::pair<const key_type, double>>(alloc));
+    double       activity_increment = 1.0;
 
     void _debug(std::string_view sv, const auto&... args) const {
         debug::debug(provider, sv, args...);
@@ -154,23 +429,147 @@ struct solver {
         changed.insert(key_of(req));
     }
 
-    auto solve() {
+    /**
+     * @brief Search for a solution without throwing on failure
+     *
+     * @return true If the partial solution is now complete
+     * @return false If there is no solution. `failed_ic` is the incompatibility that proves it.
+     */
+    bool search() {
+        if constexpr (known_unavailable_provider<provider_type, requirement_type>) {
+            load_known_unavailable();
+        }
         for (; !changed.empty(); speculate_one_decision()) {
             unit_propagation();
+            if (failed_ic) {
+                break;
+            }
+        }
+        if constexpr (activity_provider<provider_type, requirement_type>) {
+            // Scale the activities so that the next solve starts over with an increment of one
+            for (const auto& [key, act] : activity) {
+                provider.record_activity(key, act / activity_increment);
+            }
+        }
+        if (failed_ic) {
+            return false;
         }
 
         _debug("Solution complete! {}", neo::repr_value(sln));
+        if constexpr (commit_observer<provider_type, requirement_type>) {
+            if (commits == commit_policy::never) {
+                return true;
+            }
+            for (const requirement_type& req : sln.completed_solution()) {
+                commit(req);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Tell the provider that a candidate is final, unless it has already been told
+     */
+    void commit(const requirement_type& cand) {
+        if (committed.insert(key_of(cand)).second) {
+            _debug("Committing to {}", debug::try_repr{cand});
+            provider.on_commit(cand);
+        }
+    }
+
+    auto solve() {
+        if (!search()) {
+            ics.throw_failure(*failed_ic);
+        }
         return sln.completed_solution();
     }
 
+    /**
+     * @brief Record an unavailable incompatibility for each candidate that the provider knows can
+     * never be part of a solution. They are only propagated once their keys come up in the search.
+     */
+    void load_known_unavailable() {
+        if (std::exchange(known_unavailable_loaded, true)) {
+            return;
+        }
+        for (const requirement_type& req : provider.known_unavailable()) {
+            auto& ic = ics.emplace_record(std::vector{term_type{req, true}},
+                                          alloc,
+                                          typename ic_type::unavailable_cause{});
+            _debug("Loaded known-unavailable incompatibility: {}", neo::repr_value(ic));
+        }
+    }
+
+    /**
+     * @brief Rule out a solution that was returned by solve() so that the next call to solve()
+     * will resume searching for a different one. Everything learned so far is kept. The solution
+     * is ruled out by an incompatibility of its own cause, which is never retracted as a root is.
+     *
+     * If this rules out the last solution, this will throw the unsolvable_failure.
+     */
+    template <typename Solution>
+    void exclude_solution(const Solution& solution) {
+        typename ic_type::term_vec terms{alloc};
+        for (const requirement_type& req : solution) {
+            terms.push_back(term_type{req});
+        }
+        const ic_type& blocking
+            = ics.emplace_record(std::move(terms), alloc, typename ic_type::excluded_cause{});
+        _debug("Excluding previous solution with incompatibility: {}", neo::repr_value(blocking));
+        propagate_one(blocking);
+        if (failed_ic) {
+            ics.throw_failure(*failed_ic);
+        }
+    }
+
+    /**
+     * @brief Determine whether an incompatibility still holds given the retracted roots
+     */
+    bool is_active(const ic_type& ic) const noexcept {
+        if (retracted_roots.empty()) {
+            return true;
+        }
+        return sr::none_of(ics.entry_of(ic).support, [&](std::size_t idx) {
+            return idx < retracted_roots.size() && retracted_roots[idx];
+        });
+    }
+
+    /**
+     * @brief Discard the partial solution and start over from the active root incompatibilities.
+     * Every recorded incompatibility is kept, so what was learned will not need to be relearned.
+     */
+    void restart() {
+        _debug("Restarting the solver");
+        sln = sln_type{alloc};
+        ics.forget_memos();
+        changed.clear();
+        committed.clear();
+        failed_ic = nullptr;
+        for (const ic_type& ic : ics.all()) {
+            const bool seeds = std::holds_alternative<typename ic_type::root_cause>(ic.cause())
+                || std::holds_alternative<typename ic_type::excluded_cause>(ic.cause());
+            if (seeds && is_active(ic)) {
+                for (const term_type& t : ic.terms()) {
+                    changed.insert(t.key());
+                }
+            }
+        }
+    }
+
     void speculate_one_decision() {
-        const requirement_type* next_req = sln.next_unsatisfied_term();
+        const requirement_type* next_req = choose_next_term();
         if (!next_req) {
             return;
         }
 
         _debug("Speculating next unsatisfied term: {}", debug::try_repr{*next_req});
 
+        if constexpr (bundle_provider<provider_type, requirement_type>) {
+            if (adopt_bundle(*next_req)) {
+                return;
+            }
+        }
+
         // Find the best candidate package for the term
         const auto& cand_req = provider.best_candidate(*next_req);
         if (!cand_req) {
@@ -186,15 +585,160 @@ struct solver {
                debug::try_repr{*next_req},
                debug::try_repr{*cand_req});
 
-        auto&& cand_reqs      = provider.requirements_of(*cand_req);
+        if constexpr (counting_provider<provider_type, requirement_type>) {
+            const bool sole = provider.candidate_count(*next_req) == 1;
+            if constexpr (commit_observer<provider_type, requirement_type>) {
+                // Before any decision, the sole candidate can never be backed out
+                if (sole && sln.decision_level() == 0 && commits == commit_policy::early) {
+                    commit(*cand_req);
+                }
+            }
+            if (sole && force_candidate(*next_req, *cand_req)) {
+                return;
+            }
+        }
+
+        bool found_conflict = record_dependencies_of(*cand_req);
+        if (!found_conflict) {
+            _debug(
+                "No conflict was found. Recording speculation as a decision for the partial "
+                "solution");
+            sln.record_decision(term_type{*cand_req});
+            _debug("New partial solution: {}", neo::repr_value(sln));
+        }
+
+        changed.insert(key_of(*cand_req));
+    }
+
+    /**
+     * @brief Choose the unsatisfied term to decide on next
+     *
+     * If the provider tracks conflict activity, the most active unsatisfied term is chosen, and
+     * otherwise the first. If the provider can tell us which packages it can answer for without
+     * waiting, a cached term is preferred among those that rank the same. Each uncached term that
+     * we pass over is prefetched, so that it will likely be cached by the time we come back to it.
+     */
+    const requirement_type* choose_next_term() {
+        constexpr bool by_cache    = caching_provider<provider_type, requirement_type>;
+        constexpr bool by_activity = activity_provider<provider_type, requirement_type>;
+        if constexpr (by_cache || by_activity) {
+            const requirement_type* chosen        = nullptr;
+            double                  chosen_act    = 0;
+            bool                    chosen_cached = false;
+            for (const requirement_type& req : sln.unsatisfied_terms()) {
+                double act = 0;
+                if constexpr (by_activity) {
+                    act = activity_of(key_of(req));
+                }
+                bool cached = true;
+                if constexpr (by_cache) {
+                    cached = provider.is_cached(req);
+                }
+                if (!chosen || chosen_act < act
+                    || (chosen_act == act && cached && !chosen_cached)) {
+                    chosen        = &req;
+                    chosen_act    = act;
+                    chosen_cached = cached;
+                }
+            }
+            if constexpr (by_cache) {
+                for (const requirement_type& req : sln.unsatisfied_terms()) {
+                    if (&req != chosen && !provider.is_cached(req)
+                        && prefetched.insert(key_of(req)).second) {
+                        _debug("Prefetching {}", debug::try_repr{req});
+                        provider.prefetch(req);
+                    }
+                }
+            }
+            return chosen;
+        } else {
+            return sln.next_unsatisfied_term();
+        }
+    }
+
+    /**
+     * @brief Obtain the conflict activity of a key, seeding it from the provider if needed
+     */
+    double& activity_of(const key_type& k) {
+        auto found = activity.find(k);
+        if (found == activity.end()) {
+            found = activity.emplace(k, provider.initial_activity(k)).first;
+        }
+        return found->second;
+    }
+
+    /**
+     * @brief Add to the activity of each key of an incompatibility that took part in a conflict
+     */
+    void bump_activity(const ic_type& ic) {
+        for (const term_type& t : ic.terms()) {
+            activity_of(t.key()) += activity_increment;
+        }
+    }
+
+    /**
+     * @brief Make the conflicts that came before count for less than those that come after
+     */
+    void decay_activity() {
+        constexpr double decay = 0.95;
+        activity_increment /= decay;
+        if (activity_increment > 1e100) {
+            // Rescale everything before we run out of range
+            for (auto& [key, act] : activity) {
+                act *= 1e-100;
+            }
+            activity_increment *= 1e-100;
+        }
+    }
+
+    /**
+     * @brief Settle on the only candidate of a requirement without making a decision
+     *
+     * The rest of the requirement has no candidates, so we record that as an incompatibility and
+     * derive the candidate from it at the current decision level. Conflict resolution then has no
+     * decision to backjump over for this key.
+     *
+     * @return true If the candidate was derived. If the requirement names nothing but the
+     * candidate, there is nothing to derive it from, and it must be decided instead.
+     */
+    bool force_candidate(const requirement_type& next_req, const requirement_type& cand_req) {
+        auto rest = next_req.difference(cand_req);
+        if (!rest) {
+            return false;
+        }
+        const ic_type& none_left = ics.emplace_record(std::vector{term_type{*rest, true}},
+                                                      alloc,
+                                                      typename ic_type::unavailable_cause{});
+        _debug("{} is the only candidate of {}. Deriving it from {}",
+               debug::try_repr{cand_req},
+               debug::try_repr{next_req},
+               neo::repr_value(none_left));
+        if (record_dependencies_of(cand_req)) {
+            // As with a decision, leave it to unit propagation to rule out the candidate
+            _debug("The only candidate conflicts with the partial solution. Not deriving it.");
+        } else {
+            sln.record_forced_derivation(term_type{*rest, false}, none_left);
+            _debug("New partial solution: {}", neo::repr_value(sln));
+        }
+        changed.insert(key_of(cand_req));
+        return true;
+    }
+
+    /**
+     * @brief Record the dependency incompatibilities of the given candidate
+     *
+     * @return true If any of the dependencies conflict with the partial solution
+     */
+    bool record_dependencies_of(const requirement_type& cand_req) {
+        auto&& cand_reqs      = provider.requirements_of(cand_req);
         bool   found_conflict = false;
         for (requirement_type req : cand_reqs) {
-            _debug("Requirement of {}: {}", debug::try_repr{*cand_req}, debug::try_repr{req});
-            if (key_of(req) == key_of(*cand_req)) {
+            _debug("Requirement of {}: {}", debug::try_repr{cand_req}, debug::try_repr{req});
+            if (key_of(req) == key_of(cand_req)) {
                 throw std::runtime_error("Package cannot depend on itself.");
             }
             const ic_type& new_ic
-                = ics.emplace_record(std::vector{term_type{*cand_req},
+                = ics.emplace_record(std::vector{term_type{cand_req},
                                                  term_type{std::move(req), false}},
                                      alloc,
                                      typename ic_type::dependency_cause{});
@@ -203,7 +747,7 @@ struct solver {
             bool this_conflicts = std::all_of(new_ic.terms().cbegin(),
                                               new_ic.terms().cend(),
                                               [&](const term_type& ic_term) {
-                                                  return ic_term.key() == key_of(*cand_req)
+                                                  return ic_term.key() == key_of(cand_req)
                                                       || sln.satisfies(ic_term);
                                               });
             if (this_conflicts) {
@@ -212,42 +756,267 @@ struct solver {
             }
             found_conflict = found_conflict or this_conflicts;
         }
+        return found_conflict;
+    }
 
-        if (!found_conflict) {
-            _debug(
-                "No conflict was found. Recording speculation as a decision for the partial "
-                "solution");
-            sln.record_decision(term_type{*cand_req});
-            _debug("New partial solution: {}", neo::repr_value(sln));
+    /**
+     * @brief Attempt to decide on the pins of the provider's bundle for the given requirement
+     *
+     * Only the pins that are needed are adopted: the pin for the requirement, the pins for keys
+     * that the partial solution already requires, and every pin that these reach through their
+     * dependencies. The bundle is only adopted if each of these pins and each of their
+     * dependencies are still allowed by the partial solution. Otherwise we fall back to deciding
+     * one package at a time.
+     *
+     * @return true If the bundle was adopted
+     */
+    bool adopt_bundle(const requirement_type& next_req) {
+        auto&& bundle = provider.bundle_for(next_req);
+        if (!bundle) {
+            return false;
         }
 
-        changed.insert(key_of(*cand_req));
+        using req_vec = std::vector<requirement_type, rebind_alloc<requirement_type>>;
+        req_vec pins{rebind_alloc<requirement_type>(alloc)};
+        for (const requirement_type& pin : *bundle) {
+            pins.push_back(pin);
+        }
+        std::vector<bool, rebind_alloc<bool>> needed(pins.size(), false, rebind_alloc<bool>(alloc));
+        std::vector<std::size_t, rebind_alloc<std::size_t>> pending{
+            rebind_alloc<std::size_t>(alloc)};
+        auto pin_for = [&](const key_type& key) {
+            return static_cast<std::size_t>(
+                sr::find_if(pins, [&](auto&& pin) { return key_of(pin) == key; }) - pins.begin());
+        };
+        auto need = [&](std::size_t idx) {
+            if (!needed[idx]) {
+                needed[idx] = true;
+                pending.push_back(idx);
+            }
+        };
+
+        const auto own_pin = pin_for(key_of(next_req));
+        if (own_pin == pins.size() || sln.is_settled(key_of(next_req))) {
+            return false;
+        }
+        need(own_pin);
+        for (std::size_t idx = 0; idx < pins.size(); ++idx) {
+            if (sln.positive_requirement(key_of(pins[idx]))) {
+                need(idx);
+            }
+        }
+
+        while (!pending.empty()) {
+            const requirement_type& pin = pins[pending.back()];
+            pending.pop_back();
+            const auto rel = sln.relation_to(term_type{pin});
+            if (sln.is_settled(key_of(pin)) && rel == set_relation::subset) {
+                // We have already settled on this same candidate, and recorded its dependencies
+                continue;
+            }
+            if (sln.is_settled(key_of(pin)) || rel == set_relation::disjoint) {
+                _debug("Bundle pin {} is not allowed by the partial solution. Ignoring the bundle.",
+                       debug::try_repr{pin});
+                return false;
+            }
+            for (const requirement_type& dep : provider.requirements_of(pin)) {
+                const auto bundled    = pin_for(key_of(dep));
+                const bool compatible = (bundled != pins.size())
+                    ? term_type{dep}.implied_by(term_type{pins[bundled]})
+                    : sln.relation_to(term_type{dep}) != set_relation::disjoint;
+                if (!compatible) {
+                    _debug("Bundle pin {} requires {}, which cannot be satisfied. Ignoring the "
+                           "bundle.",
+                           debug::try_repr{pin},
+                           debug::try_repr{dep});
+                    return false;
+                }
+                if (bundled != pins.size()) {
+                    need(bundled);
+                }
+            }
+        }
+
+        // Each pin is propagated before the next is decided. Once a pin no longer fits, the rest
+        // are left to be decided one at a time.
+        std::size_t n_adopted = 0;
+        for (std::size_t idx = 0; idx < pins.size(); ++idx) {
+            const requirement_type& pin = pins[idx];
+            if (!needed[idx] || sln.is_settled(key_of(pin))) {
+                continue;
+            }
+            if (sln.relation_to(term_type{pin}) == set_relation::disjoint) {
+                _debug("Bundle pin {} was ruled out by an earlier pin", debug::try_repr{pin});
+                break;
+            }
+            changed.insert(key_of(pin));
+            if (record_dependencies_of(pin)) {
+                _debug("Bundle pin {} conflicts with an earlier pin", debug::try_repr{pin});
+                break;
+            }
+            sln.record_decision(term_type{pin});
+            ++n_adopted;
+            unit_propagation();
+            if (failed_ic || !sln.is_decided(key_of(pin))) {
+                // Conflict resolution backed out of the pin
+                break;
+            }
+        }
+        _debug("Adopted {} pins from the bundle for {}", n_adopted, debug::try_repr{next_req});
+        _debug("New partial solution: {}", neo::repr_value(sln));
+        return true;
     }
 
     /**
      * @brief Perform unit propagation until there are not pending changes
      */
     void unit_propagation() {
+        if (options.batched_propagation) {
+            batched_unit_propagation();
+            return;
+        }
         while (!changed.empty()) {
             auto next_unit = changed.extract(changed.begin());
             propagate_for(next_unit.value());
         }
     }
 
+    /**
+     * @brief Perform unit propagation in rounds that each visit an incompatibility at most once
+     */
+    void batched_unit_propagation() {
+        ic_ref_vec batch{rebind_alloc<ic_ref>(alloc)};
+        ic_ref_vec for_key{rebind_alloc<ic_ref>(alloc)};
+        while (!changed.empty()) {
+            const auto round = ++propagation_round;
+            batch.clear();
+            auto keys = std::exchange(changed, key_set_type(rebind_alloc<key_type>(alloc)));
+            _debug("Performing a round of unit propagation for {} keys", keys.size());
+            for (const key_type& k : keys) {
+                if constexpr (enumerating_provider<provider_type, requirement_type>) {
+                    extract_common_dependencies(k);
+                }
+                relevant_ics_for(k, for_key);
+                for (const ic_type& ic : for_key) {
+                    const auto& entry = ics.entry_of(ic);
+                    if (entry.visit_stamp != round && is_active(ic)) {
+                        entry.visit_stamp = round;
+                        batch.push_back(ic);
+                    }
+                }
+            }
+            sr::sort(batch, std::less<>{}, [&](const ic_type& ic) { return ics.entry_of(ic).seq; });
+            for (const ic_type& ic : batch) {
+                if (!propagate_one(ic)) {
+                    // Conflict resolution has reset the pending changes
+                    break;
+                }
+            }
+        }
+    }
+
     /**
      * @brief Perform unit propagation for the (pkg of) the given key
      */
     void propagate_for(const key_type& k) {
         neo_assertion_breadcrumbs("Performing unit propagation", k);
         _debug("Performing unit propagation for {}", debug::try_repr{k});
-        auto ics_for_name = ics.for_name(k);
+        if constexpr (enumerating_provider<provider_type, requirement_type>) {
+            extract_common_dependencies(k);
+        }
+        ic_ref_vec ics_for_name{rebind_alloc<ic_ref>(alloc)};
+        relevant_ics_for(k, ics_for_name);
         for (const ic_type& ic : ics_for_name) {
+            if (!is_active(ic)) {
+                continue;
+            }
             if (!propagate_one(ic)) {
                 break;
             }
         }
     }
 
+    /**
+     * @brief Collect the incompatibilities for the given key that might conflict or derive
+     * something given the current partial solution. Those whose term for the key is disjoint from
+     * the partial solution's positive term for the key are left out when we can find them quickly.
+     */
+    void relevant_ics_for(const key_type& k, ic_ref_vec& out) {
+        if constexpr (interval_requirement<requirement_type>) {
+            if (const requirement_type* pos = sln.positive_requirement(k)) {
+                stab_index.find_relevant(ics, k, *pos, out);
+                return;
+            }
+        }
+        const auto& all = ics.for_name(k);
+        out.assign(all.begin(), all.end());
+    }
+
+    /**
+     * @brief Derive the dependencies that are shared by every candidate of the given key
+     *
+     * If every candidate within the positive range of `k` depends on some other package, then that
+     * package is needed regardless of which candidate is chosen. We record that fact as a
+     * dependency incompatibility of the whole range so that unit propagation can derive it at the
+     * current decision level, before any decision is made for `k`.
+     */
+    void extract_common_dependencies(const key_type& k) {
+        const requirement_type* pos_req = sln.positive_requirement(k);
+        if (!pos_req || sln.is_settled(k) || !common_deps_done.insert(k).second) {
+            return;
+        }
+        const requirement_type range = *pos_req;
+
+        using req_vec = std::vector<requirement_type, rebind_alloc<requirement_type>>;
+        std::optional<req_vec> common;
+        for (const requirement_type& cand : provider.candidates_of(range)) {
+            auto&& cand_reqs = provider.requirements_of(cand);
+            if (!common) {
+                common.emplace(rebind_alloc<requirement_type>(alloc));
+                for (const requirement_type& req : cand_reqs) {
+                    // Only the first requirement of any given key is needed to remain sound
+                    if (key_of(req) != k && sr::none_of(*common, [&](auto&& r) {
+                            return key_of(r) == key_of(req);
+                        })) {
+                        common->push_back(req);
+                    }
+                }
+            } else {
+                std::erase_if(*common, [&](requirement_type& acc) {
+                    auto found = sr::find_if(cand_reqs, [&](auto&& r) {
+                        return key_of(r) == key_of(acc);
+                    });
+                    if (found == sr::end(cand_reqs)) {
+                        return true;
+                    }
+                    auto un = acc.union_(*found);
+                    if (!un) {
+                        return true;
+                    }
+                    acc = *un;
+                    return false;
+                });
+            }
+            if (common->empty()) {
+                return;
+            }
+        }
+
+        if (!common) {
+            // There are no candidates at all. This will be handled when we try to decide on `k`
+            return;
+        }
+
+        for (requirement_type& req : *common) {
+            const ic_type& new_ic = ics.emplace_record(
+                std::vector{term_type{range}, term_type{std::move(req), false}},
+                alloc,
+                typename ic_type::dependency_cause{});
+            _debug("  Incompatibility derived from common dependency of all candidates: {}",
+                   neo::repr_value(new_ic));
+        }
+    }
+
     /**
      * @brief Propagate a single given incompatibility
      *
@@ -257,7 +1026,7 @@ struct solver {
     bool propagate_one(const ic_type& ic) {
         neo_assertion_breadcrumbs("Propagating incompatibility", ic);
         _debug("  Propagating incompatibility: {}", neo::repr_value(ic));
-        auto res = check_conflict(ic);
+        auto res = check_conflict_memoized(ic);
 
         if (auto almost = std::get_if<almost_conflict>(&res)) {
             auto inv = almost->term.inverse();
@@ -271,6 +1040,13 @@ struct solver {
             // The cause of the conflict
             _debug("  Performing conflict resolution for {}", neo::repr_value(ic));
             const ic_type& root_cause = resolve_conflict(ic);
+            if constexpr (activity_provider<provider_type, requirement_type>) {
+                decay_activity();
+            }
+            if (failed_ic) {
+                changed.clear();
+                return false;
+            }
             _debug("  Determined root cause of conflict to be {}", neo::repr_value(root_cause));
             auto res2    = check_conflict(root_cause);
             auto almost2 = std::get_if<almost_conflict>(&res2);
@@ -334,12 +1110,54 @@ struct solver {
         return almost_conflict{*unsat_term};
     }
 
+    /**
+     * @brief Check for conflicts, skipping the check if none of the keys of the incompatibility
+     * have changed since it was last found to have no conflict.
+     */
+    conflict_result check_conflict_memoized(const ic_type& ic) const noexcept {
+        const auto& entry         = ics.entry_of(ic);
+        auto        generation_of = [&](const term_type& t) { return sln.generation_of(t.key()); };
+        if (!entry.inert_generations.empty()
+            && sr::equal(entry.inert_generations,
+                         ic.terms(),
+                         std::equal_to<>{},
+                         std::identity{},
+                         generation_of)) {
+            _debug("  No keys of {} have changed since it was last checked", neo::repr_value(ic));
+            return no_conflict{};
+        }
+
+        auto res = check_conflict(ic);
+        entry.inert_generations.clear();
+        if (std::holds_alternative<no_conflict>(res)) {
+            sr::transform(ic.terms(), std::back_inserter(entry.inert_generations), generation_of);
+        }
+        return res;
+    }
+
+    /**
+     * @brief Derive the incompatibility that explains a conflict, and backtrack to where it can
+     * derive something new. If there is nowhere to backtrack to, `failed_ic` is set instead.
+     */
     const ic_type& resolve_conflict(std::reference_wrapper<const ic_type> ic_) {
         const ic_type& original_ic = ic_;
         _debug("  Backtracking from conflicting incompatibility: {}", neo::repr_value(original_ic));
+        // If we are not retaining explanations, the intermediate incompatibilities are kept here
+        // instead of being recorded, and only the last of them is learned.
+        std::optional<ic_type> scratch;
+        auto                   support = ics.entry_of(original_ic).support;
+        auto                   learn   = [&]() -> const ic_type& {
+            if (!scratch) {
+                return ic_;
+            }
+            return ics.emplace_learned(scratch->terms(), std::move(support));
+        };
         while (true) {
             const ic_type& ic = ic_;
             neo_assertion_breadcrumbs("Performing conflict resolution", original_ic, ic);
+            if constexpr (activity_provider<provider_type, requirement_type>) {
+                bump_activity(ic);
+            }
             const auto& opt_bt_info = sln.build_backtrack_info(ic.terms());
             if (!opt_bt_info) {
                 // There is nowhere left to backtrack to: There is no possible
@@ -347,13 +1165,24 @@ struct solver {
                 _debug(
                     "  No backtracking target! We've hit a root incompatibility. Dependency "
                     "resolution fails.");
-                ics.throw_failure(ic);
+                failed_ic = &learn();
+                return *failed_ic;
             }
             const auto& [term, satisfier, prev_sat_level, difference] = *opt_bt_info;
             if (satisfier.is_decision() || prev_sat_level < satisfier.decision_level) {
                 _debug("  Found backtrack target on assignment: {}", neo::repr_value(satisfier));
-                sln.backtrack_to(prev_sat_level);
-                return ic;
+                auto target_level = prev_sat_level;
+                if (satisfier.decision_level - prev_sat_level
+                    > options.chronological_backtrack_threshold) {
+                    // Every term other than the satisfier's is satisfied at or before
+                    // prev_sat_level, so backing out only the satisfier's level is enough to turn
+                    // the conflict into a derivation.
+                    target_level = satisfier.decision_level - 1;
+                    _debug("  Backjump is too long. Backtracking chronologically to level {}",
+                           target_level);
+                }
+                sln.backtrack_to(target_level);
+                return learn();
             }
             _debug("    Stepping back through assignment: {}", neo::repr_value(satisfier));
             assert(satisfier.cause);
@@ -377,9 +1206,19 @@ struct solver {
                        "Expected conflict resolution term to be satisfied by partial solution",
                        new_terms);
 
-            ic_ = ics.emplace_record(std::move(new_terms),
-                                     alloc,
-                                     conflict_cause_type{ic, *satisfier.cause});
+            if (options.retain_explanations) {
+                ic_ = ics.emplace_record(std::move(new_terms),
+                                         alloc,
+                                         conflict_cause_type{ic, *satisfier.cause});
+            } else {
+                decltype(support) merged(support.get_allocator());
+                sr::set_union(support,
+                              ics.entry_of(*satisfier.cause).support,
+                              std::back_inserter(merged));
+                support = std::move(merged);
+                scratch.emplace(std::move(new_terms), alloc, typename ic_type::learned_cause{});
+                ic_ = *scratch;
+            }
             _debug("  Derived new intermediate incompatibility: ({})", neo::repr_value(ic_.get()));
             neo_assert(expects,
                        std::holds_alternative<conflict>(check_conflict(ic_)),
@@ -391,20 +1230,84 @@ struct solver {
 
 }  // namespace detail
 
+/**
+ * The result of `try_solve()`: Either a solution, or the failure that explains why there is none.
+ */
+template <requirement Req>
+class solve_result {
+public:
+    using requirement_type = Req;
+    using solution_type    = std::vector<requirement_type>;
+    using failure_type     = solve_failure_type_t<requirement_type>;
+
+private:
+    std::variant<solution_type, failure_type> _result;
+
+public:
+    explicit solve_result(solution_type sln)
+        : _result(std::move(sln)) {}
+    explicit solve_result(failure_type&& fail)
+        : _result(std::move(fail)) {}
+
+    bool has_value() const noexcept { return _result.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    const solution_type& value() const& noexcept {
+        neo_assert(expects, has_value(), "Accessed the solution of a failed solve");
+        return std::get<solution_type>(_result);
+    }
+    solution_type&& value() && noexcept {
+        neo_assert(expects, has_value(), "Accessed the solution of a failed solve");
+        return std::get<solution_type>(std::move(_result));
+    }
+    const solution_type& operator*() const noexcept { return value(); }
+    const solution_type* operator->() const noexcept { return &value(); }
+
+    const failure_type& failure() const& noexcept {
+        neo_assert(expects, !has_value(), "Accessed the failure of a successful solve");
+        return std::get<failure_type>(_result);
+    }
+    failure_type&& failure() && noexcept {
+        neo_assert(expects, !has_value(), "Accessed the failure of a successful solve");
+        return std::get<failure_type>(std::move(_result));
+    }
+};
+
+/**
+ * Solve for the given requirements without throwing if there is no solution. No exception is
+ * thrown or unwound within the solver on the unsolvable path.
+ */
 template <requirement_range Range, provider<std::ranges::range_value_t<Range>> P>
-decltype(auto) solve(Range&& c, P&& p) {
+auto try_solve(Range&& c, P&& p, const solve_options& opts = {}) {
+    using requirement_type = std::ranges::range_value_t<Range>;
+    using result_type      = solve_result<requirement_type>;
     neo_assertion_breadcrumbs("Solving dependency set", debug::try_repr{c}, debug::try_repr{p});
     debug::debug(p, "Solving given dependencies: {}", neo::repr(debug::try_repr{c}));
-    detail::solver<std::ranges::range_value_t<Range>, P> solver{p};
+    detail::solver<requirement_type, P> solver{p, opts};
     for (auto&& req : c) {
         solver.preload_root(req);
     }
-    return solver.solve();
+    if (!solver.search()) {
+        return result_type(solver.ics.build_failure(*solver.failed_ic));
+    }
+    return result_type(solver.sln.completed_solution());
+}
+
+/**
+ * Solve for the given requirements. Throws the failure that explains why if there is no solution.
+ */
+template <requirement_range Range, provider<std::ranges::range_value_t<Range>> P>
+auto solve(Range&& c, P&& p, const solve_options& opts = {}) {
+    auto result = try_solve(c, p, opts);
+    if (!result) {
+        throw std::move(result).failure();
+    }
+    return std::move(result).value();
 }
 
 template <requirement Req, provider<Req> P>
-decltype(auto) solve(std::initializer_list<term<Req>> il, P&& p) {
-    return solve(std::ranges::subrange{il.begin(), il.end()}, p);
+auto solve(std::initializer_list<term<Req>> il, P&& p, const solve_options& opts = {}) {
+    return solve(std::ranges::subrange{il.begin(), il.end()}, p, opts);
 }
 
 }  // namespace pubgrub
\ No newline at end of file
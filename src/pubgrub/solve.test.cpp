@@ -6,6 +6,7 @@
 #include <catch2/catch.hpp>
 
 #include <algorithm>
+#include <map>
 #include <sstream>
 
 using test_term = pubgrub::term<pubgrub::test::simple_req>;
@@ -55,6 +56,56 @@ struct test_repo {
     }
 };
 
+// A repository that can also enumerate candidates, enabling common-dependency extraction
+struct enumerating_repo : test_repo {
+    mutable std::vector<std::string> queried{};
+
+    std::optional<pubgrub::test::simple_req>
+    best_candidate(const pubgrub::test::simple_req& req) const noexcept {
+        queried.push_back(req.key);
+        return test_repo::best_candidate(req);
+    }
+
+    std::vector<pubgrub::test::simple_req>
+    candidates_of(const pubgrub::test::simple_req& req) const noexcept {
+        std::vector<pubgrub::test::simple_req> ret;
+        for (const test_package& pkg : packages) {
+            if (pkg.name == req.key && req.range.contains(pkg.version)) {
+                ret.push_back(
+                    req.with_range(pubgrub::interval_set<int>{pkg.version, pkg.version + 1}));
+            }
+        }
+        return ret;
+    }
+};
+
+static_assert(pubgrub::enumerating_provider<enumerating_repo, pubgrub::test::simple_req>);
+static_assert(!pubgrub::enumerating_provider<test_repo, pubgrub::test::simple_req>);
+
+// A repository that can count candidates, so that sole candidates are derived and not decided
+struct counting_repo : test_repo {
+    std::size_t candidate_count(const pubgrub::test::simple_req& req) const noexcept {
+        return static_cast<std::size_t>(std::ranges::count_if(packages, [&](auto&& pkg) {
+            return pkg.name == req.key && req.range.contains(pkg.version);
+        }));
+    }
+};
+
+static_assert(pubgrub::counting_provider<counting_repo, pubgrub::test::simple_req>);
+static_assert(!pubgrub::counting_provider<test_repo, pubgrub::test::simple_req>);
+
+// A counting repository that notices when the solver declines to derive a sole candidate
+struct forcing_repo : counting_repo {
+    mutable int n_forced_conflicts = 0;
+
+    void debug(std::string_view sv) const noexcept {
+        if (sv.starts_with("The only candidate conflicts")) {
+            ++n_forced_conflicts;
+        }
+        counting_repo::debug(sv);
+    }
+};
+
 template <pubgrub::provider<test_term> P>
 void foo(P&&) {}
 
@@ -227,6 +278,19 @@ TEST_CASE("Basic solving") {
     INFO("Checking solve case: " << test.name);
     auto sln = pubgrub::solve(test.roots, test.repo);
     CHECK(sln == test.expected_sln);
+
+    pubgrub::solve_options opts;
+    opts.batched_propagation = true;
+    auto batched_sln         = pubgrub::solve(test.roots, test.repo, opts);
+    CHECK(batched_sln == test.expected_sln);
+
+    counting_repo crepo{test.repo};
+    auto          counted_sln = pubgrub::solve(test.roots, crepo);
+    CHECK(counted_sln == test.expected_sln);
+
+    auto result = pubgrub::try_solve(test.roots, test.repo);
+    REQUIRE(result);
+    CHECK(*result == test.expected_sln);
 }
 
 TEST_CASE("Advanced backtracking") {
@@ -313,6 +377,322 @@ TEST_CASE("Advanced backtracking") {
     auto sln = pubgrub::solve(test.roots, test.repo);
     CHECK(sln == test.expected_sln);
     CHECK(test.repo.n_debug_messages_recvd > 0);
+
+    // Backtracking a single level at a time must reach the same answers
+    pubgrub::solve_options opts;
+    opts.chronological_backtrack_threshold = 0;
+    auto chrono_sln                        = pubgrub::solve(test.roots, test.repo, opts);
+    CHECK(chrono_sln == test.expected_sln);
+
+    // Propagating in rounds must also reach the same answers
+    pubgrub::solve_options batched_opts;
+    batched_opts.batched_propagation = true;
+    auto batched_sln                 = pubgrub::solve(test.roots, test.repo, batched_opts);
+    CHECK(batched_sln == test.expected_sln);
+
+    // Learning without keeping the explanations must also reach the same answers
+    pubgrub::solve_options bare_opts;
+    bare_opts.retain_explanations = false;
+    auto bare_sln                 = pubgrub::solve(test.roots, test.repo, bare_opts);
+    CHECK(bare_sln == test.expected_sln);
+
+    // Deriving sole candidates instead of deciding them must also reach the same answers
+    counting_repo crepo{test.repo};
+    auto          counted_sln = pubgrub::solve(test.roots, crepo);
+    CHECK(counted_sln == test.expected_sln);
+}
+
+TEST_CASE("Solve with common dependency extraction") {
+    SECTION("A dependency shared by all candidates is known before deciding") {
+        enumerating_repo erepo{repo(pkg("foo", 1, {req("bar", {1, 3})}),
+                                    pkg("foo", 2, {req("bar", {2, 4})}),
+                                    pkg("bar", 1, {}),
+                                    pkg("bar", 3, {}))};
+        auto sln = pubgrub::solve(reqs(req("foo", {1, 3})), erepo);
+        CHECK(sln == reqs(req("bar", {3, 4}), req("foo", {2, 3})));
+        // bar is needed by every candidate of foo, so it is decided before foo is looked up
+        CHECK(erepo.queried == std::vector<std::string>{"bar", "foo"});
+    }
+
+    SECTION("A shared dependency with no candidates fails without looking up the dependent") {
+        enumerating_repo erepo{repo(pkg("foo", 1, {req("bar", {1, 3})}),
+                                    pkg("foo", 2, {req("bar", {2, 4})}))};
+        CHECK_THROWS_AS(pubgrub::solve(reqs(req("foo", {1, 3})), erepo),
+                        pubgrub::unsolvable_failure_base);
+        CHECK(erepo.queried == std::vector<std::string>{"bar"});
+    }
+}
+
+// A repository that offers pre-solved bundles of packages
+struct bundle_repo : test_repo {
+    std::vector<std::vector<pubgrub::test::simple_req>> bundles{};
+    mutable int                                         n_conflicting_pins = 0;
+
+    void debug(std::string_view sv) const noexcept {
+        if (sv.ends_with("conflicts with an earlier pin")) {
+            ++n_conflicting_pins;
+        }
+        test_repo::debug(sv);
+    }
+
+    std::optional<std::vector<pubgrub::test::simple_req>>
+    bundle_for(const pubgrub::test::simple_req& req) const noexcept {
+        for (const auto& bundle : bundles) {
+            for (const auto& pin : bundle) {
+                if (pin.key == req.key && req.range.contains(pin.range)) {
+                    return bundle;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+static_assert(pubgrub::bundle_provider<bundle_repo, pubgrub::test::simple_req>);
+static_assert(!pubgrub::bundle_provider<test_repo, pubgrub::test::simple_req>);
+
+TEST_CASE("Solve with bundles") {
+    bundle_repo brepo{repo(pkg("foo", 1, {req("bar", {1, 3})}),
+                           pkg("foo", 2, {req("bar", {2, 3})}),
+                           pkg("bar", 1, {}),
+                           pkg("bar", 2, {}),
+                           pkg("baz", 1, {req("foo", {1, 3})}))};
+    brepo.bundles.push_back(reqs(req("foo", {1, 2}), req("bar", {1, 2})));
+
+    SECTION("The bundle is adopted") {
+        auto sln = pubgrub::solve(reqs(req("baz", {1, 2})), brepo);
+        CHECK(sln == reqs(req("baz", {1, 2}), req("foo", {1, 2}), req("bar", {1, 2})));
+    }
+
+    SECTION("An incompatible bundle is ignored") {
+        auto sln = pubgrub::solve(reqs(req("foo", {1, 3}), req("bar", {2, 3})), brepo);
+        CHECK(sln == reqs(req("bar", {2, 3}), req("foo", {2, 3})));
+    }
+}
+
+TEST_CASE("Bundle pins that conflict are not adopted together") {
+    bundle_repo brepo{repo(pkg("a", 1, {req("c", {1, 2})}),
+                           pkg("b", 1, {req("c", {2, 3})}),
+                           pkg("b", 2, {}),
+                           pkg("c", 1, {}),
+                           pkg("c", 2, {}))};
+    // The pins do not conflict with each other, but their dependencies do
+    brepo.bundles.push_back(reqs(req("a", {1, 2}), req("b", {1, 2})));
+
+    auto roots = reqs(req("a", {1, 2}), req("b", {1, 3}));
+    auto sln   = pubgrub::solve(roots, brepo);
+    CHECK(sln == reqs(req("a", {1, 2}), req("b", {2, 3}), req("c", {1, 2})));
+    CHECK(brepo.n_conflicting_pins == 1);
+}
+
+TEST_CASE("Only the needed pins of a bundle are adopted") {
+    bundle_repo brepo{repo(pkg("app", 1, {req("libc", {1, 2})}),
+                           pkg("tool", 1, {req("cc", {1, 2})}),
+                           pkg("cc", 1, {req("libc", {1, 2})}),
+                           pkg("cc", 2, {req("libc", {1, 2})}),
+                           pkg("libc", 1, {}),
+                           pkg("libc", 2, {}))};
+    brepo.bundles.push_back(reqs(req("cc", {1, 2}), req("libc", {1, 2})));
+
+    SECTION("A pin that nothing requires is left out") {
+        auto sln = pubgrub::solve(reqs(req("app", {1, 2})), brepo);
+        CHECK(sln == reqs(req("app", {1, 2}), req("libc", {1, 2})));
+    }
+
+    SECTION("The dependencies of a needed pin are adopted with it") {
+        auto sln = pubgrub::solve(reqs(req("tool", {1, 2})), brepo);
+        CHECK(sln == reqs(req("tool", {1, 2}), req("cc", {1, 2}), req("libc", {1, 2})));
+    }
+
+    SECTION("A pin for a key that is already required is adopted") {
+        auto sln = pubgrub::solve(reqs(req("app", {1, 2}), req("cc", {1, 3})), brepo);
+        CHECK(sln == reqs(req("app", {1, 2}), req("cc", {1, 2}), req("libc", {1, 2})));
+    }
+}
+
+TEST_CASE("Solve with forced candidates") {
+    forcing_repo crepo{repo(pkg("foo", 1, {req("bar", {1, 5})}),
+                            pkg("foo", 2, {req("bar", {2, 5})}),
+                            pkg("bar", 1, {}),
+                            pkg("bar", 3, {req("baz", {1, 10})}),
+                            pkg("baz", 7, {}),
+                            pkg("y", 1, {req("z", {1, 2})}),
+                            pkg("p", 1, {}),
+                            pkg("p", 2, {req("q", {1, 10}), req("r", {2, 3})}),
+                            pkg("q", 5, {req("r", {1, 2})}),
+                            pkg("r", 1, {}),
+                            pkg("r", 2, {}))};
+
+    SECTION("A sole candidate is derived") {
+        auto sln = pubgrub::solve(reqs(req("foo", {2, 10})), crepo);
+        CHECK(sln == reqs(req("foo", {2, 3}), req("bar", {3, 4}), req("baz", {7, 8})));
+    }
+
+    SECTION("A sole candidate of an exact requirement is decided") {
+        auto sln = pubgrub::solve(reqs(req("bar", {1, 2})), crepo);
+        CHECK(sln == reqs(req("bar", {1, 2})));
+    }
+
+    SECTION("A forced candidate that conflicts is backed out") {
+        // p=2 needs q=5, the only candidate of q, but q=5 needs a version of r that p=2 forbids
+        auto sln = pubgrub::solve(reqs(req("p", {1, 10})), crepo);
+        CHECK(sln == reqs(req("p", {1, 2})));
+        CHECK(crepo.n_forced_conflicts > 0);
+    }
+
+    SECTION("A forced candidate that cannot be satisfied fails") {
+        CHECK_THROWS_AS(pubgrub::solve(reqs(req("y", {1, 10})), crepo),
+                        pubgrub::unsolvable_failure_base);
+    }
+}
+
+// A repository that logs its queries along with the candidates that the solver commits to
+struct observed_repo : counting_repo {
+    mutable std::vector<std::string> events{};
+
+    std::optional<pubgrub::test::simple_req>
+    best_candidate(const pubgrub::test::simple_req& req) const noexcept {
+        events.push_back("query " + req.key);
+        return counting_repo::best_candidate(req);
+    }
+
+    void on_commit(const pubgrub::test::simple_req& req) { events.push_back("commit " + req.key); }
+};
+
+static_assert(pubgrub::commit_observer<observed_repo, pubgrub::test::simple_req>);
+static_assert(!pubgrub::commit_observer<counting_repo, pubgrub::test::simple_req>);
+
+TEST_CASE("Candidates are committed as soon as they are final") {
+    observed_repo orepo{repo(pkg("foo", 1, {}),
+                             pkg("foo", 2, {req("bar", {2, 5})}),
+                             pkg("bar", 3, {}),
+                             pkg("qux", 1, {}),
+                             pkg("qux", 2, {}))};
+
+    auto sln = pubgrub::solve(reqs(req("foo", {2, 10}), req("qux", {1, 10})), orepo);
+    CHECK(sln == reqs(req("foo", {2, 3}), req("bar", {3, 4}), req("qux", {2, 3})));
+    // foo and bar each have a single candidate before any decision is made. qux has two, so it
+    // is only committed once the solve is complete.
+    CHECK(orepo.events
+          == std::vector<std::string>{"query foo",
+                                      "commit foo",
+                                      "query bar",
+                                      "commit bar",
+                                      "query qux",
+                                      "commit qux"});
+}
+
+// A repository that only has some packages at hand, and logs its queries and prefetches
+struct caching_repo : test_repo {
+    std::vector<std::string>         cached{};
+    mutable std::vector<std::string> events{};
+
+    bool is_cached(const pubgrub::test::simple_req& req) const noexcept {
+        return std::ranges::find(cached, req.key) != cached.end();
+    }
+
+    void prefetch(const pubgrub::test::simple_req& req) { events.push_back("prefetch " + req.key); }
+
+    std::optional<pubgrub::test::simple_req>
+    best_candidate(const pubgrub::test::simple_req& req) const noexcept {
+        events.push_back("query " + req.key);
+        return test_repo::best_candidate(req);
+    }
+};
+
+static_assert(pubgrub::caching_provider<caching_repo, pubgrub::test::simple_req>);
+static_assert(!pubgrub::caching_provider<test_repo, pubgrub::test::simple_req>);
+
+TEST_CASE("Cached packages are decided first") {
+    caching_repo crepo{repo(pkg("a", 1, {}),
+                            pkg("a", 2, {req("c", {1, 3})}),
+                            pkg("b", 1, {}),
+                            pkg("b", 2, {}),
+                            pkg("c", 1, {}),
+                            pkg("c", 2, {}))};
+    crepo.cached = {"b", "c"};
+
+    auto sln = pubgrub::solve(reqs(req("a", {1, 3}), req("b", {1, 3})), crepo);
+    CHECK(sln == reqs(req("b", {2, 3}), req("a", {2, 3}), req("c", {2, 3})));
+    // "a" is prefetched once while "b" is decided, and is only decided once nothing else is left
+    CHECK(crepo.events == std::vector<std::string>{"prefetch a", "query b", "query a", "query c"});
+}
+
+// A repository that keeps the conflict activity of packages from one solve to the next
+struct activity_repo : test_repo {
+    std::map<std::string, double> seeds{};
+    std::map<std::string, double> recorded{};
+    mutable int                   n_queries = 0;
+
+    double initial_activity(const std::string& key) const noexcept {
+        auto found = seeds.find(key);
+        return found == seeds.end() ? 0.0 : found->second;
+    }
+
+    void record_activity(const std::string& key, double act) { recorded[key] = act; }
+
+    std::optional<pubgrub::test::simple_req>
+    best_candidate(const pubgrub::test::simple_req& req) const noexcept {
+        ++n_queries;
+        return test_repo::best_candidate(req);
+    }
+};
+
+static_assert(pubgrub::activity_provider<activity_repo, pubgrub::test::simple_req>);
+static_assert(!pubgrub::activity_provider<test_repo, pubgrub::test::simple_req>);
+
+TEST_CASE("Conflict activity orders decisions") {
+    // Deciding "a" first leads to a=2, which "z" rules out only after "x" has been decided
+    activity_repo arepo{repo(pkg("a", 1, {}),
+                             pkg("a", 2, {req("x", {1, 3})}),
+                             pkg("x", 1, {}),
+                             pkg("x", 2, {}),
+                             pkg("z", 1, {req("a", {1, 2})}))};
+    const auto    roots = reqs(req("a", {1, 3}), req("z", {1, 2}));
+
+    auto sln = pubgrub::solve(roots, arepo);
+    CHECK(sln == reqs(req("a", {1, 2}), req("z", {1, 2})));
+    CHECK(arepo.recorded["a"] > 0);
+    CHECK(arepo.recorded["z"] > 0);
+    CHECK(arepo.recorded["x"] == 0);
+    const int n_unseeded = arepo.n_queries;
+
+    // With "z" seeded as the more active, it is decided first, and "a" is never backed out
+    arepo.seeds     = {{"z", 1.0}};
+    arepo.n_queries = 0;
+    auto seeded_sln = pubgrub::solve(roots, arepo);
+    CHECK(seeded_sln == reqs(req("z", {1, 2}), req("a", {1, 2})));
+    CHECK(arepo.n_queries < n_unseeded);
+}
+
+// A repository that is both caching and keeps conflict activity
+struct caching_activity_repo : caching_repo {
+    std::map<std::string, double> seeds{};
+
+    double initial_activity(const std::string& key) const noexcept {
+        auto found = seeds.find(key);
+        return found == seeds.end() ? 0.0 : found->second;
+    }
+
+    void record_activity(const std::string&, double) {}
+};
+
+TEST_CASE("Conflict activity outranks cached packages") {
+    caching_activity_repo crepo{repo(pkg("a", 1, {}), pkg("b", 1, {}))};
+    const auto            roots = reqs(req("a", {1, 2}), req("b", {1, 2}));
+
+    SECTION("The more active package is decided first, even if it is not cached") {
+        crepo.cached = {"b"};
+        crepo.seeds  = {{"a", 1.0}};
+        pubgrub::solve(roots, crepo);
+        CHECK(crepo.events == std::vector<std::string>{"query a", "query b"});
+    }
+
+    SECTION("Activity orders the decisions when nothing is cached") {
+        crepo.seeds = {{"b", 1.0}};
+        pubgrub::solve(roots, crepo);
+        CHECK(crepo.events == std::vector<std::string>{"prefetch a", "query b", "query a"});
+    }
 }
 
 TEST_CASE("Unsolvable") {
@@ -374,6 +754,104 @@ TEST_CASE("Unsolvable") {
         pubgrub::generate_explaination(fail, [&](auto&&) {});
     }
     CHECK(test.repo.n_debug_messages_recvd > 0);
+
+    pubgrub::solve_options opts;
+    opts.chronological_backtrack_threshold = 0;
+    CHECK_THROWS_AS(pubgrub::solve(test.roots, test.repo, opts), exception_type);
+
+    pubgrub::solve_options batched_opts;
+    batched_opts.batched_propagation = true;
+    CHECK_THROWS_AS(pubgrub::solve(test.roots, test.repo, batched_opts), exception_type);
+
+    // Without explanations, the failure holds only the incompatibility that proved it
+    pubgrub::solve_options bare_opts;
+    bare_opts.retain_explanations = false;
+    try {
+        pubgrub::solve(test.roots, test.repo, bare_opts);
+        FAIL("Expected a solver failure");
+    } catch (const exception_type& fail) {
+        CHECK(fail.incompatibilities().size() == 1);
+    }
+
+    // The same failure can be had without an exception
+    auto result = pubgrub::try_solve(test.roots, test.repo);
+    REQUIRE_FALSE(result);
+    CHECK_FALSE(result.failure().incompatibilities().empty());
+    pubgrub::generate_explaination(result.failure(), [&](auto&&) {});
+}
+
+TEST_CASE("Learned incompatibilities are checked for subsumption") {
+    using ic_type = pubgrub::incompatibility<pubgrub::test::simple_req>;
+    pubgrub::detail::ic_record<ic_type> rec{ic_type::allocator_type{}};
+
+    const auto& dep = rec.emplace_record(std::vector{test_term{req("foo", {1, 2})},
+                                                     test_term{req("bar", {1, 5}), false}},
+                                         ic_type::allocator_type{},
+                                         ic_type::dependency_cause{});
+    const auto& root
+        = rec.emplace_record(std::vector{test_term{req("bar", {1, 5})}},
+                             ic_type::allocator_type{},
+                             ic_type::root_cause{});
+    CHECK(rec.for_name("foo").size() == 1);
+    CHECK(rec.for_name("bar").size() == 2);
+
+    // Implied by the dependency, so it is never propagated
+    const auto& weaker = rec.emplace_record(std::vector{test_term{req("foo", {1, 2})},
+                                                        test_term{req("bar", {1, 7}), false},
+                                                        test_term{req("baz", {1, 2})}},
+                                            ic_type::allocator_type{},
+                                            ic_type::conflict_cause{dep, root});
+    CHECK(rec.entry_of(weaker).retired);
+    CHECK(rec.for_name("foo").size() == 1);
+    CHECK(rec.for_name("bar").size() == 2);
+
+    // Implies the dependency, but was derived from a root. The dependency must remain in case
+    // that root is retracted.
+    const auto& rooted = rec.emplace_record(std::vector{test_term{req("foo", {0, 5})}},
+                                            ic_type::allocator_type{},
+                                            ic_type::conflict_cause{dep, root});
+    CHECK_FALSE(rec.entry_of(rooted).retired);
+    CHECK_FALSE(rec.entry_of(dep).retired);
+    CHECK(rec.for_name("foo").size() == 2);
+
+    // Implies the dependency and does not depend on any root, so both of the above are retired
+    const auto& stronger = rec.emplace_record(std::vector{test_term{req("foo", {0, 5})}},
+                                              ic_type::allocator_type{},
+                                              ic_type::conflict_cause{dep, dep});
+    CHECK_FALSE(rec.entry_of(stronger).retired);
+    CHECK(rec.entry_of(dep).retired);
+    CHECK(rec.entry_of(rooted).retired);
+    REQUIRE(rec.for_name("foo").size() == 1);
+    CHECK(&rec.for_name("foo").front().get() == &stronger);
+    CHECK(rec.for_name("bar").size() == 1);
+}
+
+TEST_CASE("Failures copy a shared derivation once") {
+    using ic_type = pubgrub::incompatibility<pubgrub::test::simple_req>;
+    pubgrub::detail::ic_record<ic_type> rec{ic_type::allocator_type{}};
+
+    const auto& dep = rec.emplace_record(std::vector{test_term{req("foo", {1, 2})},
+                                                     test_term{req("bar", {1, 2}), false}},
+                                         ic_type::allocator_type{},
+                                         ic_type::dependency_cause{});
+    const auto& unavail
+        = rec.emplace_record(std::vector{test_term{req("bar", {1, 2})}},
+                             ic_type::allocator_type{},
+                             ic_type::unavailable_cause{});
+    const auto& shared
+        = rec.emplace_record(std::vector{test_term{req("foo", {1, 2})}},
+                             ic_type::allocator_type{},
+                             ic_type::conflict_cause{dep, unavail});
+    // Both sides of the conflict are the same derivation
+    const auto& root = rec.emplace_record(std::vector<test_term>{},
+                                          ic_type::allocator_type{},
+                                          ic_type::conflict_cause{shared, shared});
+
+    auto fail = rec.build_failure(root);
+    REQUIRE(fail.incompatibilities().size() == 4);
+    const auto& [left, right] = std::get<ic_type::conflict_cause>(
+        fail.incompatibilities().back().cause());
+    CHECK(&left == &right);
 }
 
 struct explain_handler {
@@ -403,10 +881,24 @@ struct explain_handler {
         message << comp.left << " and " << comp.right << " aggree on " << comp.result;
     }
 
+    void say(pubgrub::explain::dependency_chain<pubgrub::test::simple_req> chain) {
+        message << chain.dependent << " requires " << chain.dependency << " through "
+                << chain.length << " dependencies";
+    }
+
+    void say(pubgrub::explain::excluded<pubgrub::test::simple_req> ex) {
+        for (const auto& t : ex.solution) {
+            message << (&t == ex.solution.data() ? "" : ", ") << t.requirement;
+        }
+        message << " is excluded by a previous solution";
+    }
+
     void say(pubgrub::explain::no_solution) { message << "There is no solution"; }
 
     void operator()(pubgrub::explain::separator) { message << '\n'; }
 
+    void operator()(pubgrub::explain::truncated) { message << "...\n"; }
+
     template <typename What>
     void operator()(pubgrub::explain::conclusion<What> c) {
         message << "Thus: ";
@@ -438,4 +930,124 @@ TEST_CASE("Explain 1") {
                                   "Thus: There is no solution\n");
     }
     CHECK(test.repo.n_debug_messages_recvd > 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Explain a failure without its derivation") {
+    auto test = test_case("Missing dependency",
+                          repo(pkg("foo", 1, {req("bar", {1, 2})})),
+                          reqs(req("foo", {1, 2})),
+                          sln());
+    pubgrub::solve_options opts;
+    opts.retain_explanations = false;
+    try {
+        pubgrub::solve(test.roots, test.repo, opts);
+        FAIL("Expected a failure");
+    } catch (const pubgrub::solve_failure_type_t<pubgrub::test::simple_req>& fail) {
+        explain_handler ex;
+        pubgrub::generate_explaination(fail, ex);
+        CHECK(ex.message.str() == "Thus: There is no solution\n");
+
+        explain_handler budgeted;
+        pubgrub::generate_explaination(fail, budgeted, 1);
+        CHECK(budgeted.message.str() == "Thus: There is no solution\n");
+    }
+}
+
+TEST_CASE("Explain an excluded solution") {
+    auto test = test_case("Single solution",
+                          repo(pkg("foo", 1, {})),
+                          reqs(req("foo", {1, 3})),
+                          sln(req("foo", {1, 2})));
+    pubgrub::detail::solver<pubgrub::test::simple_req, test_repo> solver{test.repo};
+    for (auto& root : test.roots) {
+        solver.preload_root(root);
+    }
+    auto found = solver.solve();
+    CHECK(found == test.expected_sln);
+    try {
+        solver.exclude_solution(found);
+        solver.solve();
+        FAIL("Expected the only solution to be ruled out");
+    } catch (const pubgrub::solve_failure_type_t<pubgrub::test::simple_req>& fail) {
+        explain_handler ex;
+        pubgrub::generate_explaination(fail, ex);
+        CHECK(ex.message.str() == "Known: foo [2, 3) is not available\n"
+                                  "Known: foo [1, 2) is excluded by a previous solution\n"
+                                  "Thus: foo [1, 3) is not allowed\n"
+                                  "Known: foo [1, 3) is needed\n"
+                                  "Thus: There is no solution\n");
+    }
+    // The exclusion is not a root, so it cannot be retracted
+    using ic_type        = pubgrub::incompatibility<pubgrub::test::simple_req>;
+    const auto& blocking = *std::ranges::find_if(solver.ics.all(), [](const ic_type& ic) {
+        return std::holds_alternative<ic_type::excluded_cause>(ic.cause());
+    });
+    CHECK(solver.ics.entry_of(blocking).support.empty());
+}
+
+TEST_CASE("Explain with a budget") {
+    auto test = test_case("Long dependency chain",
+                          repo(pkg("a", 1, {req("b", {1, 2})}),
+                               pkg("b", 1, {req("c", {1, 2})}),
+                               pkg("c", 1, {req("d", {1, 2})}),
+                               pkg("d", 1, {req("e", {1, 2})})),
+                          reqs(req("a", {1, 2})),
+                          sln());
+    try {
+        pubgrub::solve(test.roots, test.repo);
+        FAIL("Expected a failure");
+    } catch (const pubgrub::solve_failure_type_t<pubgrub::test::simple_req>& fail) {
+        explain_handler ex;
+        pubgrub::generate_explaination(fail, ex, 100);
+        CHECK(ex.message.str()
+              == "Known: a [1, 2) requires c [1, 2) through 2 dependencies\n"
+                 "Thus: a [1, 2) requires c [1, 2)\n"
+                 "Known: c [1, 2) requires e [1, 2) through 2 dependencies\n"
+                 "Thus: a [1, 2) requires e [1, 2)\n"
+                 "Known: e [1, 2) is not available\n"
+                 "Known: a [1, 2) is needed\n"
+                 "Thus: There is no solution\n");
+
+        explain_handler cut;
+        pubgrub::generate_explaination(fail, cut, 1);
+        // There is no room to explain how "a" comes to require "e", so it is not walked at all
+        CHECK(cut.message.str()
+              == "...\n"
+                 "Known: a [1, 2) requires e [1, 2)\n"
+                 "...\n"
+                 "Thus: There is no solution\n");
+
+        explain_handler part;
+        pubgrub::generate_explaination(fail, part, 3);
+        CHECK(part.message.str()
+              == "Known: a [1, 2) requires c [1, 2) through 2 dependencies\n"
+                 "Thus: a [1, 2) requires c [1, 2)\n"
+                 "Known: c [1, 2) requires e [1, 2) through 2 dependencies\n"
+                 "...\n"
+                 "Thus: There is no solution\n");
+    }
+}
+
+TEST_CASE("Only collapse dependencies that form a chain") {
+    using pubgrub::test::simple_req;
+    using dep_premise = pubgrub::explain::premise<pubgrub::explain::dependency<simple_req>>;
+    explain_handler                                                        ex;
+    pubgrub::detail::budgeted_explain_handler<simple_req, explain_handler> budget{ex, 10};
+
+    auto a  = req("a", {1, 2});
+    auto b  = req("b", {1, 3});
+    auto b2 = req("b", {2, 3});
+    auto c  = req("c", {1, 2});
+    auto c5 = req("c", {1, 5});
+    auto d  = req("d", {1, 2});
+    // a=1 may use b=1, which does not need c, so a does not require c
+    budget(dep_premise{{a, b}});
+    budget(dep_premise{{b2, c}});
+    // Every version of c that b=2 needs requires d
+    budget(dep_premise{{c5, d}});
+    budget(pubgrub::explain::conclusion<pubgrub::explain::no_solution>{{}});
+    CHECK(ex.message.str()
+          == "Known: a [1, 2) requires b [1, 3)\n"
+             "Known: b [2, 3) requires d [1, 2) through 2 dependencies\n"
+             "Thus: There is no solution\n");
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+#include <pubgrub/debug.hpp>
+#include <pubgrub/solve.hpp>
+
+#include <neo/assert.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace pubgrub {
+
+/**
+ * A provider that can identify the exact state of the package data that it serves. Two providers
+ * with equal snapshot IDs must give identical answers to every query.
+ */
+template <typename Provider>
+concept snapshot_provider = requires(const Provider provider) {
+    { provider.snapshot_id() } -> std::convertible_to<std::string_view>;
+};
+
+/**
+ * Remember the results of solving for sets of root requirements against provider snapshots.
+ *
+ * Roots are canonicalized by sorting them by key and folding the roots of each key into their
+ * intersection, so the same set of roots given in a different order will hit the same cache entry.
+ * Roots of one key that have no versions in common are kept as given, as the solve can only fail.
+ * On a miss, the solver is run on the canonical roots so that the cached result does not depend on
+ * which order was seen first. Failures are cached as well and are rethrown on every hit.
+ *
+ * A cache uses the same solve_options for every solve that it runs. It holds at most `capacity()`
+ * entries: once full, the entry that has gone unused the longest is evicted to make room. Cached
+ * failures hold their whole derivation, so the capacity bounds that memory as well.
+ */
+template <requirement Req>
+requires detail::equality_comparable<Req>
+class solve_cache {
+public:
+    using requirement_type = Req;
+    using key_type         = key_type_t<requirement_type>;
+    using solution_type    = std::vector<requirement_type>;
+
+private:
+    struct entry {
+        std::size_t                                     hash;
+        std::string                                     snapshot;
+        std::vector<requirement_type>                   roots;
+        std::variant<solution_type, std::exception_ptr> result;
+    };
+
+    using entry_list = std::list<entry>;
+
+    solve_options _options;
+    std::size_t   _capacity = default_capacity;
+    // Entries from the most to the least recently used
+    entry_list _entries;
+    // Entries by the hash of their snapshot and roots
+    std::unordered_multimap<std::size_t, typename entry_list::iterator> _index;
+
+    void _evict_oldest() noexcept {
+        const auto oldest  = std::prev(_entries.end());
+        auto [first, last] = _index.equal_range(oldest->hash);
+        _index.erase(std::find_if(first, last, [&](auto&& pair) { return pair.second == oldest; }));
+        _entries.erase(oldest);
+    }
+
+    static std::vector<requirement_type> _canonicalize(std::vector<requirement_type> roots) {
+        std::ranges::stable_sort(roots, std::less<>{}, pubgrub::key_of);
+        std::vector<requirement_type> canon;
+        canon.reserve(roots.size());
+        for (requirement_type& req : roots) {
+            if (!canon.empty() && key_of(canon.back()) == key_of(req)) {
+                if (auto isect = canon.back().intersection(req)) {
+                    canon.back() = std::move(*isect);
+                    continue;
+                }
+            }
+            canon.push_back(std::move(req));
+        }
+        return canon;
+    }
+
+    static std::size_t _hash(std::string_view                     snapshot,
+                             const std::vector<requirement_type>& roots) noexcept {
+        // Requirements are not required to be hashable, so we only hash their keys. Roots that
+        // differ only in their ranges are told apart by comparing them in full.
+        std::size_t seed = std::hash<std::string_view>{}(snapshot);
+        for (const requirement_type& req : roots) {
+            seed ^= std::hash<key_type>{}(key_of(req)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+
+public:
+    /// The number of entries kept by a cache constructed without an explicit capacity
+    static constexpr std::size_t default_capacity = 1024;
+
+    solve_cache() = default;
+    explicit solve_cache(solve_options opts, std::size_t capacity = default_capacity)
+        : _options(opts)
+        , _capacity(capacity) {
+        neo_assert(expects, capacity > 0, "A solve_cache must be able to hold an entry");
+    }
+
+    /**
+     * Solve for the given roots, or return (or rethrow) the result of a previous solve of the same
+     * roots against the same provider snapshot.
+     */
+    template <requirement_range Range, provider<requirement_type> P>
+    requires snapshot_provider<P>
+    solution_type solve(Range&& roots, P&& p) {
+        const std::vector<requirement_type> canon = _canonicalize(
+            std::vector<requirement_type>(std::ranges::begin(roots), std::ranges::end(roots)));
+        const std::string snapshot{std::string_view(p.snapshot_id())};
+        const std::size_t hash = _hash(snapshot, canon);
+
+        auto [first, last] = _index.equal_range(hash);
+        auto found         = std::find_if(first, last, [&](auto&& pair) {
+            return pair.second->snapshot == snapshot && pair.second->roots == canon;
+        });
+        if (found == last) {
+            entry new_entry{hash, snapshot, canon, solution_type{}};
+            try {
+                new_entry.result = pubgrub::solve(canon, p, _options);
+            } catch (const unsolvable_failure_base&) {
+                new_entry.result = std::current_exception();
+            }
+            if (_entries.size() == _capacity) {
+                _evict_oldest();
+            }
+            _entries.push_front(std::move(new_entry));
+            _index.emplace(hash, _entries.begin());
+        } else {
+            debug::debug(p,
+                         "Using cached result for solving {}",
+                         neo::repr(debug::try_repr{canon}));
+            _entries.splice(_entries.begin(), _entries, found->second);
+        }
+
+        const entry& ent = _entries.front();
+        if (auto fail = std::get_if<std::exception_ptr>(&ent.result)) {
+            std::rethrow_exception(*fail);
+        }
+        return std::get<solution_type>(ent.result);
+    }
+
+    std::size_t size() const noexcept { return _entries.size(); }
+    std::size_t capacity() const noexcept { return _capacity; }
+    void        clear() noexcept {
+        _index.clear();
+        _entries.clear();
+    }
+};
+
+}  // namespace pubgrub
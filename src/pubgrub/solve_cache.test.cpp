@@ -0,0 +1,111 @@
+#include "./solve_cache.hpp"
+
+#include <pubgrub/memory_provider.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+using pubgrub::test::simple_req;
+using pubgrub::test::ver;
+
+namespace {
+
+struct snapshot_repo : pubgrub::test::counting_memory_provider {
+    std::string snapshot = "snap-1";
+
+    std::string_view snapshot_id() const noexcept { return snapshot; }
+};
+
+}  // namespace
+
+TEST_CASE("Cache solve results") {
+    snapshot_repo repo;
+    repo.add(ver("foo", 1), {simple_req{"bar", {1, 10}}});
+    repo.add(ver("bar", 4), {});
+    repo.add(ver("baz", 2), {});
+
+    pubgrub::solve_cache<simple_req> cache;
+    auto sln = cache.solve(std::vector{simple_req{"foo", {1, 2}}, simple_req{"baz", {1, 5}}}, repo);
+    CHECK(sln == std::vector{ver("bar", 4), ver("baz", 2), ver("foo", 1)});
+    const auto n_queries = repo.n_queries;
+    CHECK(n_queries > 0);
+
+    // Root order does not matter
+    auto sln2
+        = cache.solve(std::vector{simple_req{"baz", {1, 5}}, simple_req{"foo", {1, 2}}}, repo);
+    CHECK(sln2 == sln);
+    CHECK(repo.n_queries == n_queries);
+    CHECK(cache.size() == 1);
+
+    // Different ranges or a different snapshot are different entries
+    cache.solve(std::vector{simple_req{"baz", {1, 3}}, simple_req{"foo", {1, 2}}}, repo);
+    CHECK(cache.size() == 2);
+    repo.snapshot = "snap-2";
+    cache.solve(std::vector{simple_req{"baz", {1, 5}}, simple_req{"foo", {1, 2}}}, repo);
+    CHECK(cache.size() == 3);
+}
+
+TEST_CASE("Cache solve results for roots that repeat a key") {
+    snapshot_repo repo;
+    repo.add(ver("foo", 1), {});
+    repo.add(ver("foo", 2), {});
+    repo.add(ver("foo", 4), {});
+
+    pubgrub::solve_cache<simple_req> cache;
+    auto sln = cache.solve(std::vector{simple_req{"foo", {1, 5}}, simple_req{"foo", {2, 3}}}, repo);
+    CHECK(sln == std::vector{ver("foo", 2)});
+    const auto n_queries = repo.n_queries;
+
+    // The roots of a key are folded into their intersection, whatever their order
+    auto sln2
+        = cache.solve(std::vector{simple_req{"foo", {2, 3}}, simple_req{"foo", {1, 5}}}, repo);
+    CHECK(sln2 == sln);
+    cache.solve(std::vector{simple_req{"foo", {2, 3}}}, repo);
+    CHECK(repo.n_queries == n_queries);
+    CHECK(cache.size() == 1);
+}
+
+TEST_CASE("Cache solve failures") {
+    snapshot_repo repo;
+    repo.add(ver("foo", 1), {simple_req{"bar", {1, 10}}});
+
+    using failure_type = pubgrub::solve_failure_type_t<simple_req>;
+    pubgrub::solve_cache<simple_req> cache;
+    auto roots = std::vector{simple_req{"foo", {1, 2}}};
+    CHECK_THROWS_AS(cache.solve(roots, repo), failure_type);
+    const auto n_queries = repo.n_queries;
+    try {
+        cache.solve(roots, repo);
+        FAIL("Expected a cached failure");
+    } catch (const failure_type& fail) {
+        CHECK_FALSE(fail.incompatibilities().empty());
+    }
+    CHECK(repo.n_queries == n_queries);
+}
+
+TEST_CASE("Evict the least recently used solve results") {
+    snapshot_repo repo;
+    repo.add(ver("foo", 1), {});
+    repo.add(ver("bar", 1), {});
+    repo.add(ver("baz", 1), {});
+
+    pubgrub::solve_cache<simple_req> cache{pubgrub::solve_options{}, 2};
+    CHECK(cache.capacity() == 2);
+    auto foo = std::vector{simple_req{"foo", {1, 2}}};
+    auto bar = std::vector{simple_req{"bar", {1, 2}}};
+    auto baz = std::vector{simple_req{"baz", {1, 2}}};
+    cache.solve(foo, repo);
+    cache.solve(bar, repo);
+    // Using foo again makes bar the oldest entry, which is evicted to make room for baz
+    cache.solve(foo, repo);
+    cache.solve(baz, repo);
+    CHECK(cache.size() == 2);
+
+    auto n_queries = repo.n_queries;
+    cache.solve(foo, repo);
+    cache.solve(baz, repo);
+    CHECK(repo.n_queries == n_queries);
+    cache.solve(bar, repo);
+    CHECK(repo.n_queries > n_queries);
+    CHECK(cache.size() == 2);
+}
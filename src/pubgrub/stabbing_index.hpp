@@ -0,0 +1,226 @@
+#pragma once
+
+#include <pubgrub/concepts.hpp>
+#include <pubgrub/term.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace pubgrub::detail {
+
+/**
+ * An index over the incompatibilities of an `ic_record` that finds, for a key, those whose term
+ * for that key is not disjoint from a given positive requirement. Those are the only ones that
+ * can derive anything or conflict when the partial solution's term for the key is that
+ * requirement.
+ *
+ * For each key, the positive terms are kept in arrays sorted by the low end of their envelopes,
+ * along with the running maximum of the high ends. A query is two binary searches followed by a
+ * scan of only the terms that might overlap. Negative terms of a single interval are kept in
+ * their own arrays of endpoints, and each query classifies all of them in one pass.
+ *
+ * The index for a key covers the incompatibilities that were recorded when it was built. Those
+ * recorded later are checked one at a time, and the index is rebuilt once there are enough of
+ * them.
+ * Results are given in the order the incompatibilities were recorded, just as `for_name()` gives
+ * them.
+ */
+template <typename IC>
+requires interval_requirement<typename IC::term_type::requirement_type>
+class stabbing_index {
+public:
+    using ic_type          = IC;
+    using term_type        = typename ic_type::term_type;
+    using requirement_type = typename term_type::requirement_type;
+    using key_type         = typename term_type::key_type;
+    using allocator_type   = typename ic_type::allocator_type;
+    using element_type     = typename std::remove_cvref_t<
+        decltype(std::declval<const requirement_type&>().range)>::element_type;
+
+    /// Lists shorter than this are not worth indexing
+    static constexpr std::size_t min_indexed_size = 32;
+
+private:
+    template <typename T>
+    using vec = std::vector<T, rebind_alloc_t<allocator_type, T>>;
+
+    struct key_index {
+        explicit key_index(allocator_type alloc)
+            : lows(alloc)
+            , highs(alloc)
+            , max_highs(alloc)
+            , positives(alloc)
+            , neg_lows(alloc)
+            , neg_highs(alloc)
+            , negatives(alloc)
+            , others(alloc) {}
+
+        // Incompatibilities recorded before this sequence number are indexed
+        std::size_t indexed_upto = 0;
+        std::size_t n_indexed    = 0;
+
+        // Positive terms, sorted by the low end of their envelopes
+        vec<element_type>   lows;
+        vec<element_type>   highs;
+        vec<element_type>   max_highs;
+        vec<const ic_type*> positives;
+        // Negative terms of a single interval
+        vec<element_type>   neg_lows;
+        vec<element_type>   neg_highs;
+        vec<const ic_type*> negatives;
+        // Terms that we cannot classify by their envelope. These are always relevant.
+        vec<const ic_type*> others;
+    };
+
+    using index_map_alloc = rebind_alloc_t<allocator_type, std::pair<const key_type, key_index>>;
+
+    allocator_type                                              _alloc;
+    std::map<key_type, key_index, std::less<>, index_map_alloc> _indexes{_alloc};
+    // Scratch space for marking the terms that are not disjoint
+    vec<std::uint8_t> _mask{_alloc};
+
+    static const term_type& _term_for(const ic_type& ic, const key_type& k) noexcept {
+        return *std::ranges::find_if(ic.terms(), [&](const term_type& t) { return t.key() == k; });
+    }
+
+    static bool _is_single_interval(const auto& range) noexcept {
+        std::size_t n = 0;
+        for ([[maybe_unused]] const auto& iv : range.iter_intervals()) {
+            if (++n > 1) {
+                break;
+            }
+        }
+        return n == 1;
+    }
+
+    template <typename Record, typename List>
+    void _rebuild(key_index& idx, const key_type& k, const List& list) {
+        struct positive_term {
+            element_type   low;
+            element_type   high;
+            const ic_type* ic;
+        };
+        vec<positive_term> sorted{_alloc};
+        idx.neg_lows.clear();
+        idx.neg_highs.clear();
+        idx.negatives.clear();
+        idx.others.clear();
+        for (const ic_type& ic : list) {
+            const term_type& term  = _term_for(ic, k);
+            const auto&      range = term.requirement.range;
+            if (range.empty()) {
+                idx.others.push_back(&ic);
+            } else if (term.positive) {
+                const auto env = range.envelope();
+                sorted.push_back(positive_term{env.low, env.high, &ic});
+            } else if (_is_single_interval(range)) {
+                const auto env = range.envelope();
+                idx.neg_lows.push_back(env.low);
+                idx.neg_highs.push_back(env.high);
+                idx.negatives.push_back(&ic);
+            } else {
+                idx.others.push_back(&ic);
+            }
+        }
+        std::ranges::stable_sort(sorted, std::less<>{}, &positive_term::low);
+
+        idx.lows.clear();
+        idx.highs.clear();
+        idx.max_highs.clear();
+        idx.positives.clear();
+        for (const positive_term& pt : sorted) {
+            idx.lows.push_back(pt.low);
+            idx.highs.push_back(pt.high);
+            idx.max_highs.push_back(idx.max_highs.empty() || idx.max_highs.back() < pt.high
+                                        ? pt.high
+                                        : idx.max_highs.back());
+            idx.positives.push_back(pt.ic);
+        }
+        idx.n_indexed    = list.size();
+        idx.indexed_upto = list.empty() ? 0 : Record::entry_of(list.back()).seq + 1;
+    }
+
+public:
+    explicit stabbing_index(allocator_type alloc)
+        : _alloc(alloc) {}
+
+    /**
+     * Fill `out` with the incompatibilities of `ics` for key `k` whose term for `k` might not be
+     * disjoint from `req`.
+     */
+    template <typename Record, typename Out>
+    void find_relevant(const Record&           ics,
+                       const key_type&         k,
+                       const requirement_type& req,
+                       Out&                    out) {
+        const auto& list = ics.for_name(k);
+        out.clear();
+        if (list.size() < min_indexed_size || req.range.empty()) {
+            out.assign(list.begin(), list.end());
+            return;
+        }
+
+        auto& idx  = _indexes.try_emplace(k, _alloc).first->second;
+        auto  tail = std::ranges::partition_point(list, [&](const ic_type& ic) {
+            return Record::entry_of(ic).seq < idx.indexed_upto;
+        });
+        const auto n_tail = static_cast<std::size_t>(std::ranges::distance(tail, list.end()));
+        if (n_tail > std::max(min_indexed_size, idx.n_indexed / 2)) {
+            _rebuild<Record>(idx, k, list);
+            tail = list.end();
+        }
+
+        auto is_live = [](const ic_type* ic) { return !Record::entry_of(*ic).retired; };
+        auto gather  = [&](const vec<const ic_type*>& ics, std::size_t first) {
+            for (std::size_t i = 0; i < _mask.size(); ++i) {
+                if (_mask[i] && is_live(ics[first + i])) {
+                    out.push_back(*ics[first + i]);
+                }
+            }
+        };
+
+        // The marking loops below have no branches, so that they can be vectorized for
+        // arithmetic version types.
+        const auto        env  = req.range.envelope();
+        const std::size_t stop = static_cast<std::size_t>(
+            std::ranges::lower_bound(idx.lows, env.high) - idx.lows.begin());
+        const std::size_t start = static_cast<std::size_t>(
+            std::upper_bound(idx.max_highs.begin(), idx.max_highs.begin() + stop, env.low)
+            - idx.max_highs.begin());
+        // A positive term that starts before our end is disjoint if it ends before our start
+        _mask.resize(stop - start);
+        for (std::size_t i = start; i < stop; ++i) {
+            _mask[i - start] = static_cast<std::uint8_t>(env.low < idx.highs[i]);
+        }
+        gather(idx.positives, start);
+
+        // A negative term is disjoint if `req` lies entirely within its range
+        const std::size_t n_neg = idx.negatives.size();
+        _mask.resize(n_neg);
+        for (std::size_t i = 0; i < n_neg; ++i) {
+            _mask[i] = static_cast<std::uint8_t>((env.low < idx.neg_lows[i])
+                                                 | (idx.neg_highs[i] < env.high));
+        }
+        gather(idx.negatives, 0);
+
+        for (const ic_type* ic : idx.others) {
+            if (is_live(ic)) {
+                out.push_back(*ic);
+            }
+        }
+        const term_type req_term{req};
+        for (const ic_type& ic : std::ranges::subrange(tail, list.end())) {
+            if (req_term.relation_to(_term_for(ic, k)) != set_relation::disjoint) {
+                out.push_back(ic);
+            }
+        }
+        std::ranges::sort(out, std::less<>{}, [](const ic_type& ic) {
+            return Record::entry_of(ic).seq;
+        });
+    }
+};
+
+}  // namespace pubgrub::detail
@@ -0,0 +1,61 @@
+#include "./stabbing_index.hpp"
+
+#include <pubgrub/solve.hpp>
+#include <pubgrub/test_util.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <random>
+
+using pubgrub::test::simple_req;
+using ic_type   = pubgrub::incompatibility<simple_req>;
+using term_type = pubgrub::term<simple_req>;
+
+TEST_CASE("Stabbing index finds the incompatibilities that overlap a requirement") {
+    pubgrub::detail::ic_record<ic_type>      rec{ic_type::allocator_type{}};
+    pubgrub::detail::stabbing_index<ic_type> index{ic_type::allocator_type{}};
+
+    std::mt19937 rng{1729};
+    auto         add_some = [&](int n) {
+        for (int i = 0; i < n; ++i) {
+            const int  low      = static_cast<int>(rng() % 100);
+            const int  high     = low + 1 + static_cast<int>(rng() % 10);
+            const bool positive = rng() % 4 != 0;
+            rec.emplace_record(std::vector{term_type{simple_req{"foo", {low, high}}, positive},
+                                           term_type{simple_req{"bar", {1, 2}}, false}},
+                               ic_type::allocator_type{},
+                               ic_type::dependency_cause{});
+        }
+    };
+
+    auto check_query = [&](int low, int high) {
+        const simple_req req{"foo", {low, high}};
+        std::vector<std::reference_wrapper<const ic_type>> found;
+        index.find_relevant(rec, "foo", req, found);
+
+        std::vector<std::reference_wrapper<const ic_type>> expected;
+        for (const ic_type& ic : rec.for_name("foo")) {
+            const term_type& t = ic.terms().back();
+            REQUIRE(t.key() == "foo");
+            const bool disjoint = t.positive ? t.requirement.excludes(req)
+                                             : t.requirement.implied_by(req);
+            if (!disjoint) {
+                expected.push_back(ic);
+            }
+        }
+
+        INFO("Querying [" << low << ", " << high << ")");
+        REQUIRE(found.size() == expected.size());
+        for (std::size_t i = 0; i < found.size(); ++i) {
+            CHECK(&found[i].get() == &expected[i].get());
+        }
+    };
+
+    add_some(200);
+    for (int i = 0; i < 50; ++i) {
+        const int low = static_cast<int>(rng() % 110);
+        check_query(low, low + 1 + static_cast<int>(rng() % 20));
+        // Incompatibilities recorded after the index was built are still found
+        add_some(7);
+    }
+}
@@ -2,10 +2,13 @@
 
 #include <pubgrub/concepts.hpp>
 #include <pubgrub/interval.hpp>
+#include <pubgrub/memory_provider.hpp>
 #include <pubgrub/term.hpp>
 
+#include <limits>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace pubgrub::test {
 
@@ -104,6 +107,12 @@ struct simple_req {
     auto implied_by(simple_req other) const noexcept { return range.contains(other.range); }
     auto excludes(simple_req other) const noexcept { return range.disjoint(other.range); }
 
+    /// Whether this requirement accepts every version from some minimum upwards
+    bool lower_bound_only() const noexcept {
+        constexpr auto top = std::numeric_limits<int>::max();
+        return !range.empty() && range == version_range_type{range.envelope().low, top};
+    }
+
     friend bool operator==(const simple_req& lhs, const simple_req& rhs) noexcept {
         return std::tie(lhs.key, lhs.range) == std::tie(rhs.key, rhs.range);
     }
@@ -123,6 +132,30 @@ struct simple_req {
 
 using simple_term = pubgrub::term<simple_req>;
 
+/// A requirement on exactly one version of a package
+inline simple_req ver(std::string name, version v) {
+    return simple_req{std::move(name), {v, v + 1}};
+}
+
+/// A memory_provider that counts how many candidates have been looked up
+struct counting_memory_provider : memory_provider<simple_req> {
+    mutable int n_queries = 0;
+
+    std::optional<simple_req> best_candidate(const simple_req& req) const noexcept {
+        ++n_queries;
+        return memory_provider::best_candidate(req);
+    }
+};
+
+/// A memory_provider that records each candidate that the solver commits to
+struct observed_memory_provider : memory_provider<simple_req> {
+    std::vector<simple_req> committed;
+
+    std::size_t candidate_count(const simple_req& req) const { return candidates_of(req).size(); }
+
+    void on_commit(const simple_req& cand) { committed.push_back(cand); }
+};
+
 template <pubgrub::requirement R>
 void check_req(R) {}
 